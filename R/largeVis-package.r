@@ -22,6 +22,19 @@
 #' The package also includes implementations of the HDBSCAN, DBSCAN, and OPTICS clustering algorithms, and LOF outlier detection, optimized to use
 #' data generated by running \code{largeVis}.
 #'
+#' Setting \code{options(largeVis.profile = TRUE)} makes \code{\link{randomProjectionTreeSearch}} of a dense matrix, \code{\link{buildWijMatrix}}, \code{\link{projectKNNs}},
+#' \code{\link{hdbscan}}, \code{\link{lv_optics}} and \code{\link{lv_dbscan}} attach a \code{profile} attribute to their results.
+#' It is a list of \code{phases}, a data frame of the wall and CPU seconds spent in each phase of the computation; \code{counters},
+#' such as the number of distances evaluated or samples processed; and \code{thread_busy}, the seconds each thread spent working.
+#' With \code{options(largeVis.perf = TRUE)} as well, on Linux, \code{phases} also has the \code{cycles}, \code{instructions},
+#' \code{llc_misses} (last-level cache read misses) and \code{dtlb_misses} (data TLB read misses) counted in user space by all the
+#' threads during each phase, from \code{perf_event_open}. Events the system does not allow to be counted are \code{NA}.
+#'
+#' Setting \code{options(largeVis.trace)} to a file name records a timeline of the same functions' phases, and of the work each thread
+#' does within them: random projection trees, the merging of their leaves, chunks of vertices and batches of gradient descent. The events
+#' are appended to the file in the Chrome trace format, which can be opened in \code{chrome://tracing} or \url{https://ui.perfetto.dev}.
+#' Each thread keeps only its most recent 65536 events.
+#'
 #' @references Jian Tang, Jingzhou Liu, Ming Zhang, Qiaozhu Mei. \href{https://arxiv.org/abs/1602.00370}{Visualizing Large-scale and High-dimensional Data.}
 #' R. Campello, D. Moulavi, and J. Sander, Density-Based Clustering Based on Hierarchical Density Estimates In: Advances in Knowledge Discovery and Data Mining, Springer, pp 160-172. 2013
 #' Mihael Ankerst, Markus M. Breunig, Hans-Peter Kriegel, Jorg Sander (1999). OPTICS: Ordering Points To Identify the Clustering Structure. ACM SIGMOD international conference on Management of data. ACM Press. pp. 49-60.
@@ -27,8 +27,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // dbscan_cpp
-IntegerVector dbscan_cpp(const arma::sp_mat& edges, const arma::imat& neighbors, double eps, int minPts, bool verbose);
-RcppExport SEXP largeVis_dbscan_cpp(SEXP edgesSEXP, SEXP neighborsSEXP, SEXP epsSEXP, SEXP minPtsSEXP, SEXP verboseSEXP) {
+SEXP dbscan_cpp(const arma::sp_mat& edges, const arma::imat& neighbors, double eps, int minPts, Rcpp::Nullable<Rcpp::NumericVector> threads, bool verbose);
+RcppExport SEXP largeVis_dbscan_cpp(SEXP edgesSEXP, SEXP neighborsSEXP, SEXP epsSEXP, SEXP minPtsSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -36,13 +36,29 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const arma::imat& >::type neighbors(neighborsSEXP);
     Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
     Rcpp::traits::input_parameter< int >::type minPts(minPtsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
     Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
-    rcpp_result_gen = Rcpp::wrap(dbscan_cpp(edges, neighbors, eps, minPts, verbose));
+    rcpp_result_gen = Rcpp::wrap(dbscan_cpp(edges, neighbors, eps, minPts, threads, verbose));
+    return rcpp_result_gen;
+END_RCPP
+}
+// dbscan_coords
+SEXP dbscan_coords(const arma::mat& coords, double eps, int minPts, Rcpp::Nullable<Rcpp::NumericVector> threads, bool verbose);
+RcppExport SEXP largeVis_dbscan_coords(SEXP coordsSEXP, SEXP epsSEXP, SEXP minPtsSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::mat& >::type coords(coordsSEXP);
+    Rcpp::traits::input_parameter< double >::type eps(epsSEXP);
+    Rcpp::traits::input_parameter< int >::type minPts(minPtsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
+    rcpp_result_gen = Rcpp::wrap(dbscan_coords(coords, eps, minPts, threads, verbose));
     return rcpp_result_gen;
 END_RCPP
 }
 // searchTrees
-arma::imat searchTrees(const int& threshold, const int& n_trees, const int& K, const int& maxIter, const arma::mat& data, const std::string& distMethod, Rcpp::Nullable< NumericVector > seed, Rcpp::Nullable< NumericVector > threads, bool verbose);
+SEXP searchTrees(const int& threshold, const int& n_trees, const int& K, const int& maxIter, const arma::mat& data, const std::string& distMethod, Rcpp::Nullable< NumericVector > seed, Rcpp::Nullable< NumericVector > threads, bool verbose);
 RcppExport SEXP largeVis_searchTrees(SEXP thresholdSEXP, SEXP n_treesSEXP, SEXP KSEXP, SEXP maxIterSEXP, SEXP dataSEXP, SEXP distMethodSEXP, SEXP seedSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
@@ -60,6 +76,21 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// searchKDTree
+SEXP searchKDTree(const int& K, const arma::mat& data, const std::string& distMethod, Rcpp::Nullable< NumericVector > threads, bool verbose);
+RcppExport SEXP largeVis_searchKDTree(SEXP KSEXP, SEXP dataSEXP, SEXP distMethodSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const int& >::type K(KSEXP);
+    Rcpp::traits::input_parameter< const arma::mat& >::type data(dataSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type distMethod(distMethodSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< NumericVector > >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type verbose(verboseSEXP);
+    rcpp_result_gen = Rcpp::wrap(searchKDTree(K, data, distMethod, threads, verbose));
+    return rcpp_result_gen;
+END_RCPP
+}
 // fastDistance
 arma::vec fastDistance(const IntegerVector is, const IntegerVector js, const arma::mat& data, const std::string& distMethod, Rcpp::Nullable<Rcpp::NumericVector> threads, bool verbose);
 RcppExport SEXP largeVis_fastDistance(SEXP isSEXP, SEXP jsSEXP, SEXP dataSEXP, SEXP distMethodSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
@@ -113,7 +144,7 @@ BEGIN_RCPP
 END_RCPP
 }
 // referenceWij
-arma::sp_mat referenceWij(const arma::ivec& i, const arma::ivec& j, arma::vec& d, Rcpp::Nullable<Rcpp::NumericVector> threads, double perplexity);
+SEXP referenceWij(const arma::ivec& i, const arma::ivec& j, arma::vec& d, Rcpp::Nullable<Rcpp::NumericVector> threads, double perplexity);
 RcppExport SEXP largeVis_referenceWij(SEXP iSEXP, SEXP jSEXP, SEXP dSEXP, SEXP threadsSEXP, SEXP perplexitySEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
@@ -128,8 +159,8 @@ BEGIN_RCPP
 END_RCPP
 }
 // hdbscanc
-List hdbscanc(const arma::sp_mat& edges, const IntegerMatrix& neighbors, const int& K, const int& minPts, const Rcpp::Nullable<Rcpp::NumericVector> threads, const bool verbose);
-RcppExport SEXP largeVis_hdbscanc(SEXP edgesSEXP, SEXP neighborsSEXP, SEXP KSEXP, SEXP minPtsSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
+SEXP hdbscanc(const arma::sp_mat& edges, const IntegerMatrix& neighbors, const int& K, const int& minPts, const std::string& mstMethod, const bool& membership, const Rcpp::Nullable<Rcpp::NumericVector> threads, const bool verbose);
+RcppExport SEXP largeVis_hdbscanc(SEXP edgesSEXP, SEXP neighborsSEXP, SEXP KSEXP, SEXP minPtsSEXP, SEXP mstMethodSEXP, SEXP membershipSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -137,14 +168,91 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< const IntegerMatrix& >::type neighbors(neighborsSEXP);
     Rcpp::traits::input_parameter< const int& >::type K(KSEXP);
     Rcpp::traits::input_parameter< const int& >::type minPts(minPtsSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type mstMethod(mstMethodSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type membership(membershipSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type verbose(verboseSEXP);
+    rcpp_result_gen = Rcpp::wrap(hdbscanc(edges, neighbors, K, minPts, mstMethod, membership, threads, verbose));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hdbscan_coords
+SEXP hdbscan_coords(const arma::mat& coords, const int& graphK, const int& K, const int& minPts, const std::string& mstMethod, const bool& membership, const Rcpp::Nullable<Rcpp::NumericVector> threads, const bool verbose);
+RcppExport SEXP largeVis_hdbscan_coords(SEXP coordsSEXP, SEXP graphKSEXP, SEXP KSEXP, SEXP minPtsSEXP, SEXP mstMethodSEXP, SEXP membershipSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::mat& >::type coords(coordsSEXP);
+    Rcpp::traits::input_parameter< const int& >::type graphK(graphKSEXP);
+    Rcpp::traits::input_parameter< const int& >::type K(KSEXP);
+    Rcpp::traits::input_parameter< const int& >::type minPts(minPtsSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type mstMethod(mstMethodSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type membership(membershipSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type verbose(verboseSEXP);
+    rcpp_result_gen = Rcpp::wrap(hdbscan_coords(coords, graphK, K, minPts, mstMethod, membership, threads, verbose));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hdbscan_sweepc
+List hdbscan_sweepc(const arma::sp_mat& edges, const IntegerMatrix& neighbors, const IntegerVector& K, const IntegerVector& minPts, const std::string& mstMethod, const Rcpp::Nullable<Rcpp::NumericVector> threads, const bool verbose);
+RcppExport SEXP largeVis_hdbscan_sweepc(SEXP edgesSEXP, SEXP neighborsSEXP, SEXP KSEXP, SEXP minPtsSEXP, SEXP mstMethodSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::sp_mat& >::type edges(edgesSEXP);
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type neighbors(neighborsSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type K(KSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type minPts(minPtsSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type mstMethod(mstMethodSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< const bool >::type verbose(verboseSEXP);
+    rcpp_result_gen = Rcpp::wrap(hdbscan_sweepc(edges, neighbors, K, minPts, mstMethod, threads, verbose));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hdbscan_extractc
+List hdbscan_extractc(const IntegerVector& nodeMembership, const NumericVector& lambdas, const IntegerVector& clusterParent, const NumericVector& stability, const LogicalVector& selected, const NumericVector& lambdaBirth, const std::string& method, const double& epsilon, const Rcpp::Nullable<Rcpp::NumericVector> threads);
+RcppExport SEXP largeVis_hdbscan_extractc(SEXP nodeMembershipSEXP, SEXP lambdasSEXP, SEXP clusterParentSEXP, SEXP stabilitySEXP, SEXP selectedSEXP, SEXP lambdaBirthSEXP, SEXP methodSEXP, SEXP epsilonSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const IntegerVector& >::type nodeMembership(nodeMembershipSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type lambdas(lambdasSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type clusterParent(clusterParentSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type stability(stabilitySEXP);
+    Rcpp::traits::input_parameter< const LogicalVector& >::type selected(selectedSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type lambdaBirth(lambdaBirthSEXP);
+    Rcpp::traits::input_parameter< const std::string& >::type method(methodSEXP);
+    Rcpp::traits::input_parameter< const double& >::type epsilon(epsilonSEXP);
+    Rcpp::traits::input_parameter< const Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(hdbscan_extractc(nodeMembership, lambdas, clusterParent, stability, selected, lambdaBirth, method, epsilon, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// hdbscan_predictc
+List hdbscan_predictc(const IntegerVector& nodeMembership, const NumericVector& lambdas, const IntegerVector& clusterParent, const LogicalVector& selected, const NumericVector& lambdaBirth, const NumericVector& coreDistances, const IntegerMatrix& neighbors, const NumericMatrix& distances, const int& K, const Rcpp::Nullable<Rcpp::NumericVector> threads, const bool verbose);
+RcppExport SEXP largeVis_hdbscan_predictc(SEXP nodeMembershipSEXP, SEXP lambdasSEXP, SEXP clusterParentSEXP, SEXP selectedSEXP, SEXP lambdaBirthSEXP, SEXP coreDistancesSEXP, SEXP neighborsSEXP, SEXP distancesSEXP, SEXP KSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const IntegerVector& >::type nodeMembership(nodeMembershipSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type lambdas(lambdasSEXP);
+    Rcpp::traits::input_parameter< const IntegerVector& >::type clusterParent(clusterParentSEXP);
+    Rcpp::traits::input_parameter< const LogicalVector& >::type selected(selectedSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type lambdaBirth(lambdaBirthSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type coreDistances(coreDistancesSEXP);
+    Rcpp::traits::input_parameter< const IntegerMatrix& >::type neighbors(neighborsSEXP);
+    Rcpp::traits::input_parameter< const NumericMatrix& >::type distances(distancesSEXP);
+    Rcpp::traits::input_parameter< const int& >::type K(KSEXP);
     Rcpp::traits::input_parameter< const Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
     Rcpp::traits::input_parameter< const bool >::type verbose(verboseSEXP);
-    rcpp_result_gen = Rcpp::wrap(hdbscanc(edges, neighbors, K, minPts, threads, verbose));
+    rcpp_result_gen = Rcpp::wrap(hdbscan_predictc(nodeMembership, lambdas, clusterParent, selected, lambdaBirth, coreDistances, neighbors, distances, K, threads, verbose));
     return rcpp_result_gen;
 END_RCPP
 }
 // sgd
-arma::mat sgd(arma::mat& coords, arma::ivec& targets_i, arma::ivec& sources_j, arma::ivec& ps, arma::vec& weights, const double& gamma, const double& rho, const arma::uword& n_samples, const int& M, const double& alpha, const Rcpp::Nullable<Rcpp::NumericVector> momentum, const bool& useDegree, const Rcpp::Nullable<Rcpp::NumericVector> seed, const Rcpp::Nullable<Rcpp::NumericVector> threads, const bool verbose);
+SEXP sgd(arma::mat& coords, arma::ivec& targets_i, arma::ivec& sources_j, arma::ivec& ps, arma::vec& weights, const double& gamma, const double& rho, const arma::uword& n_samples, const int& M, const double& alpha, const Rcpp::Nullable<Rcpp::NumericVector> momentum, const bool& useDegree, const Rcpp::Nullable<Rcpp::NumericVector> seed, const Rcpp::Nullable<Rcpp::NumericVector> threads, const bool verbose);
 RcppExport SEXP largeVis_sgd(SEXP coordsSEXP, SEXP targets_iSEXP, SEXP sources_jSEXP, SEXP psSEXP, SEXP weightsSEXP, SEXP gammaSEXP, SEXP rhoSEXP, SEXP n_samplesSEXP, SEXP MSEXP, SEXP alphaSEXP, SEXP momentumSEXP, SEXP useDegreeSEXP, SEXP seedSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
@@ -168,8 +276,23 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// louvain_cpp
+List louvain_cpp(const arma::sp_mat& wij, const double& resolution, const int& maxLevels, Rcpp::Nullable<Rcpp::NumericVector> threads, const bool& verbose);
+RcppExport SEXP largeVis_louvain_cpp(SEXP wijSEXP, SEXP resolutionSEXP, SEXP maxLevelsSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::sp_mat& >::type wij(wijSEXP);
+    Rcpp::traits::input_parameter< const double& >::type resolution(resolutionSEXP);
+    Rcpp::traits::input_parameter< const int& >::type maxLevels(maxLevelsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type verbose(verboseSEXP);
+    rcpp_result_gen = Rcpp::wrap(louvain_cpp(wij, resolution, maxLevels, threads, verbose));
+    return rcpp_result_gen;
+END_RCPP
+}
 // optics_cpp
-List optics_cpp(const arma::sp_mat& edges, const arma::imat& neighbors, const double& eps, const int& minPts, const bool& useQueue, const bool& verbose);
+SEXP optics_cpp(const arma::sp_mat& edges, const arma::imat& neighbors, const double& eps, const int& minPts, const bool& useQueue, const bool& verbose);
 RcppExport SEXP largeVis_optics_cpp(SEXP edgesSEXP, SEXP neighborsSEXP, SEXP epsSEXP, SEXP minPtsSEXP, SEXP useQueueSEXP, SEXP verboseSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
@@ -184,6 +307,65 @@ BEGIN_RCPP
     return rcpp_result_gen;
 END_RCPP
 }
+// optics_coords
+SEXP optics_coords(const arma::mat& coords, const double& eps, const int& minPts, const bool& useQueue, Rcpp::Nullable<Rcpp::NumericVector> threads, const bool& verbose);
+RcppExport SEXP largeVis_optics_coords(SEXP coordsSEXP, SEXP epsSEXP, SEXP minPtsSEXP, SEXP useQueueSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::mat& >::type coords(coordsSEXP);
+    Rcpp::traits::input_parameter< const double& >::type eps(epsSEXP);
+    Rcpp::traits::input_parameter< const int& >::type minPts(minPtsSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type useQueue(useQueueSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< const bool& >::type verbose(verboseSEXP);
+    rcpp_result_gen = Rcpp::wrap(optics_coords(coords, eps, minPts, useQueue, threads, verbose));
+    return rcpp_result_gen;
+END_RCPP
+}
+// optics_extract_cpp
+List optics_extract_cpp(const IntegerVector& order, const NumericVector& reachdist, const NumericVector& coredist, const NumericVector& epsCl, const NumericVector& xi, const int& minPts, Rcpp::Nullable<Rcpp::NumericVector> threads);
+RcppExport SEXP largeVis_optics_extract_cpp(SEXP orderSEXP, SEXP reachdistSEXP, SEXP coredistSEXP, SEXP epsClSEXP, SEXP xiSEXP, SEXP minPtsSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const IntegerVector& >::type order(orderSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type reachdist(reachdistSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type coredist(coredistSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type epsCl(epsClSEXP);
+    Rcpp::traits::input_parameter< const NumericVector& >::type xi(xiSEXP);
+    Rcpp::traits::input_parameter< const int& >::type minPts(minPtsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(optics_extract_cpp(order, reachdist, coredist, epsCl, xi, minPts, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// lof_cpp
+NumericVector lof_cpp(const arma::sp_mat& edges, Rcpp::Nullable<Rcpp::NumericVector> threads);
+RcppExport SEXP largeVis_lof_cpp(SEXP edgesSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::sp_mat& >::type edges(edgesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(lof_cpp(edges, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// outlier_scores_cpp
+NumericMatrix outlier_scores_cpp(const arma::sp_mat& edges, const std::vector< std::string >& methods, const double& lambda, Rcpp::Nullable<Rcpp::NumericVector> threads);
+RcppExport SEXP largeVis_outlier_scores_cpp(SEXP edgesSEXP, SEXP methodsSEXP, SEXP lambdaSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< const arma::sp_mat& >::type edges(edgesSEXP);
+    Rcpp::traits::input_parameter< const std::vector< std::string >& >::type methods(methodsSEXP);
+    Rcpp::traits::input_parameter< const double& >::type lambda(lambdaSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable<Rcpp::NumericVector> >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(outlier_scores_cpp(edges, methods, lambda, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
 // searchTreesCSparse
 arma::imat searchTreesCSparse(const int& threshold, const int& n_trees, const int& K, const int& maxIter, const arma::uvec& i, const arma::uvec& p, const arma::vec& x, const std::string& distMethod, Rcpp::Nullable< Rcpp::NumericVector> seed, Rcpp::Nullable< Rcpp::NumericVector> threads, bool verbose);
 RcppExport SEXP largeVis_searchTreesCSparse(SEXP thresholdSEXP, SEXP n_treesSEXP, SEXP KSEXP, SEXP maxIterSEXP, SEXP iSEXP, SEXP pSEXP, SEXP xSEXP, SEXP distMethodSEXP, SEXP seedSEXP, SEXP threadsSEXP, SEXP verboseSEXP) {
@@ -59,7 +59,7 @@ public:
 			probs[small.front()] = 1;
 			small.pop();
 		}
-		if (accu > 1e-5) Rcpp::warning("Numerical instability in alias table " + to_string(accu));
+		if (accu > 1e-5) largeVisWarning("Numerical instability in alias table " + to_string(accu));
 	};
 
 	long initRandom(long seed) {
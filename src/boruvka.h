@@ -0,0 +1,212 @@
+#ifndef _LARGEVISBORUVKA
+#define _LARGEVISBORUVKA
+#include "largeVis.h"
+#include "progress.hpp"
+#include "unionfind.h"
+#include "neighborgraph.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*
+ * Parallel alternative to PrimsAlgorithm.
+ *
+ * Each round finds, in parallel, the lightest edge leaving every component of the
+ * mutual-reachability graph, and contracts along those edges with a concurrent union-find.
+ * Ties are broken on the vertex indices of the edge, so the spanning forest is unique and
+ * does not depend on the number of threads. The forest is then rooted at the smallest vertex
+ * of each tree, to produce the same parent array and merge sequence as PrimsAlgorithm.
+ */
+template<class VIDX, class D>
+class BoruvkaAlgorithm {
+private:
+	struct MSTEdge {
+		VIDX from;
+		VIDX to;
+		D distance;
+		MSTEdge(const VIDX& from, const VIDX& to, const D& distance) : from{from}, to{to}, distance{distance} {}
+	};
+
+	const VIDX N;
+	const VIDX NONE;
+	const D* coreDistances;
+	VIDX* minimum_spanning_tree;
+	D* keys;
+
+	VIDX* componentOf;
+	VIDX* candidateTarget;
+	D* candidateDistance;
+	std::atomic<VIDX>* bestCandidate;
+	bool* finished;
+
+	inline D mutualReachability(const VIDX& v, const VIDX& w, const D& d) const {
+		return fmax(d, std::max(coreDistances[v], coreDistances[w]));
+	}
+
+	static inline bool lighter(const D& d1, const VIDX& v1, const VIDX& w1,
+                             const D& d2, const VIDX& v2, const VIDX& w2) {
+		if (d1 != d2) return d1 < d2;
+		const VIDX lo1 = std::min(v1, w1), lo2 = std::min(v2, w2);
+		if (lo1 != lo2) return lo1 < lo2;
+		return std::max(v1, w1) < std::max(v2, w2);
+	}
+
+	inline void considerEdge(const VIDX& v, const VIDX& w, const D& d) {
+		if (componentOf[w] == componentOf[v]) return;
+		const D dist = mutualReachability(v, w, d);
+		if (candidateTarget[v] == NONE ||
+      lighter(dist, v, w, candidateDistance[v], v, candidateTarget[v])) {
+			candidateTarget[v] = w;
+			candidateDistance[v] = dist;
+		}
+	}
+
+	void findCandidate(const VIDX& v, const NeighborGraph& graph) {
+		candidateTarget[v] = NONE;
+		for (auto it = graph.begin(v); it != graph.end(v); ++it) {
+			considerEdge(v, it->neighbor, it->distance);
+		}
+	}
+
+	// Keep the lightest candidate offered by any vertex in the component.
+	void offerCandidate(const VIDX& v) {
+		std::atomic<VIDX>& best = bestCandidate[componentOf[v]];
+		VIDX current = best.load();
+		while (current == NONE ||
+         lighter(candidateDistance[v], v, candidateTarget[v],
+                 candidateDistance[current], current, candidateTarget[current])) {
+			if (best.compare_exchange_weak(current, v)) return;
+		}
+	}
+
+	void orient(const std::vector< MSTEdge >& forest, ConcurrentUnionFind<VIDX>& components) {
+		std::vector< VIDX > offsets(N + 1, 0);
+		for (auto it = forest.begin(); it != forest.end(); ++it) {
+			offsets[it->from + 1]++;
+			offsets[it->to + 1]++;
+		}
+		for (VIDX n = 0; n != N; ++n) offsets[n + 1] += offsets[n];
+		std::vector< VIDX > adjacent(offsets[N]);
+		std::vector< D > adjacentDistance(offsets[N]);
+		std::vector< VIDX > fill(offsets.begin(), offsets.end() - 1);
+		for (auto it = forest.begin(); it != forest.end(); ++it) {
+			adjacent[fill[it->from]] = it->to;
+			adjacentDistance[fill[it->from]++] = it->distance;
+			adjacent[fill[it->to]] = it->from;
+			adjacentDistance[fill[it->to]++] = it->distance;
+		}
+
+		std::vector< VIDX > queue;
+		queue.reserve(N);
+		for (VIDX root = 0; root != N; ++root) if (components.find(root) == root) {
+			queue.clear();
+			queue.push_back(root);
+			for (VIDX q = 0; q != queue.size(); ++q) {
+				const VIDX v = queue[q];
+				for (VIDX e = offsets[v]; e != offsets[v + 1]; ++e) {
+					const VIDX w = adjacent[e];
+					if (w == root || minimum_spanning_tree[w] != (VIDX) NA_INTEGER) continue;
+					minimum_spanning_tree[w] = v;
+					keys[w] = adjacentDistance[e];
+					queue.push_back(w);
+				}
+			}
+		}
+	}
+
+public:
+	BoruvkaAlgorithm(const VIDX& N, const D* coreDistances) :
+		N{N}, NONE{N}, coreDistances{coreDistances} {
+		minimum_spanning_tree = new VIDX[N];
+		keys = new D[N];
+		componentOf = new VIDX[N];
+		candidateTarget = new VIDX[N];
+		candidateDistance = new D[N];
+		bestCandidate = new std::atomic<VIDX>[N];
+		finished = new bool[N];
+	}
+
+	BoruvkaAlgorithm(const BoruvkaAlgorithm& b) : BoruvkaAlgorithm(b.N, b.coreDistances) {};
+
+	~BoruvkaAlgorithm() {
+		delete[] minimum_spanning_tree;
+		delete[] keys;
+		delete[] componentOf;
+		delete[] candidateTarget;
+		delete[] candidateDistance;
+		delete[] bestCandidate;
+		delete[] finished;
+	}
+
+	VIDX* run(const NeighborGraph& graph, Progress& p) {
+		ConcurrentUnionFind<VIDX> components(N);
+		for (VIDX n = 0; n != N; ++n) {
+			minimum_spanning_tree[n] = NA_INTEGER;
+			keys[n] = INFINITY;
+			bestCandidate[n].store(NONE);
+			finished[n] = false;
+		}
+		std::vector< MSTEdge > forest;
+		forest.reserve(N);
+
+		bool merged = true;
+		while (merged && ! p.check_abort()) {
+			const size_t roundStart = forest.size();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+			for (VIDX n = 0; n < N; ++n) componentOf[n] = components.find(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 4096)
+#endif
+			for (VIDX n = 0; n < N; ++n) {
+				if (finished[componentOf[n]]) candidateTarget[n] = NONE;
+				else findCandidate(n, graph);
+			}
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+			for (VIDX n = 0; n < N; ++n) if (candidateTarget[n] != NONE) offerCandidate(n);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+			{
+				std::vector< MSTEdge > local;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+				for (VIDX n = 0; n < N; ++n) if (componentOf[n] == n && ! finished[n]) {
+					const VIDX best = bestCandidate[n].load();
+					if (best == NONE) finished[n] = true;
+					else {
+						const VIDX target = candidateTarget[best];
+						if (components.unite(best, target)) local.emplace_back(best, target, candidateDistance[best]);
+						bestCandidate[n].store(NONE);
+					}
+				}
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+				forest.insert(forest.end(), local.begin(), local.end());
+			}
+			/*
+			 * A component with nothing left to offer can still be reached from a neighbor if the
+			 * neighbor and edge matrices disagree, in which case it has to be revisited.
+			 */
+			for (size_t e = roundStart; e != forest.size(); ++e) finished[components.find(forest[e].from)] = false;
+			merged = forest.size() != roundStart;
+			if (! p.increment(forest.size() - roundStart)) break;
+		}
+		orient(forest, components);
+		return minimum_spanning_tree;
+	}
+
+	std::vector< std::pair<D, VIDX> > getMergeSequence() const {
+		std::vector< std::pair<D, VIDX> > container;
+		container.reserve(N);
+		for (VIDX n = 0; n != N; ++n) container.emplace_back(keys[n], n);
+		sort(container.begin(), container.end());
+		return container;
+	}
+};
+#endif
@@ -0,0 +1,217 @@
+#ifndef _LARGEVISDBSCAN
+#define _LARGEVISDBSCAN
+#include "largeVis.h"
+#include <progress.hpp>
+#include "neighborgraph.h"
+#include "unionfind.h"
+#include "profiler.h"
+#include <numeric>
+
+using namespace std;
+using namespace arma;
+
+/*
+ * DBSCAN, in parallel, with the same labels as a serial scan that starts clusters at unvisited
+ * core points in index order.
+ *
+ * The neighborhood of p is its nearest neighbors up to the first one beyond eps and, only if all K of
+ * them are within eps, the reverse neighbors closer than eps. Since that relation is not symmetric,
+ * a core point belongs to the cluster of the smallest core point from which it can be reached,
+ * through a chain of core points each in the neighborhood of the last. Core points that are in each
+ * other's neighborhoods are joined with a concurrent union-find, whose root is the smallest member of
+ * each set; the one-way links between sets are then searched from each set in index order, so that
+ * every set carries the smallest index that reaches it. A border point takes the lowest-numbered cluster with a core point whose
+ * neighborhood contains it.
+ */
+class DBSCAN {
+protected:
+	const NeighborGraph* graph;
+	const long double eps;
+	const unsigned int minPts;
+	const long long N;
+	vector< kidxtype > within; // Leading nearest neighbors within eps
+	vector< char > exceeded; // Whether the reverse neighbors are excluded
+	vector< char > core;
+	Progress progress;
+	Profiler& profiler;
+
+	template<class F>
+	void forRegion(const long long& p, F f) const {
+		for (auto it = graph->beginNeighbors(p); it != graph->beginNeighbors(p) + within[p]; it++) f(it->neighbor);
+		if (! exceeded[p]) {
+			for (auto it = graph->beginReverse(p);
+        	 it != graph->endReverse(p);
+        	 it++) {
+				if (it->distance < eps) f(it->neighbor);
+			}
+		}
+	}
+
+	// Whether q is in the neighborhood of p, where q is in p's row of the graph.
+	bool inRegion(const long long& p, const long long& q) const {
+		// Every pair in a graph of all pairs within eps is mutual.
+		if (graph->radius() <= eps) return true;
+		for (auto it = graph->beginNeighbors(p); it != graph->beginNeighbors(p) + within[p]; it++) {
+			if (it->neighbor == q) return true;
+		}
+		if (exceeded[p]) return false;
+		const auto it = lower_bound(graph->beginReverse(p), graph->endReverse(p), q,
+                                [](const NeighborGraph::Edge& e, const long long& v) { return e.neighbor < v; });
+		return it != graph->endReverse(p) && it->neighbor == q && it->distance < eps;
+	}
+
+	void findCores() {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+		{
+			Profiler::Busy busy(profiler);
+#ifdef _OPENMP
+#pragma omp for nowait
+#endif
+			for (long long p = 0; p < N; p++) {
+				kidxtype k = 0;
+				for (auto it = graph->beginNeighbors(p); it != graph->endNeighbors(p) && it->distance <= eps; it++) k++;
+				within[p] = k;
+				exceeded[p] = k < graph->neighborsPerVertex();
+				long long count = 0;
+				forRegion(p, [&count](const long long&) { count++; });
+				core[p] = count >= minPts - 1;
+			}
+		}
+		progress.increment(N);
+	}
+
+	// For each core point, the smallest core point from which it can be reached.
+	vector< long long > findSources() {
+		ConcurrentUnionFind< long long > components(N);
+		vector< pair< long long, long long > > links;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+		{
+			Profiler::Busy busy(profiler);
+			vector< pair< long long, long long > > local;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 4096)
+#endif
+			for (long long p = 0; p < N; p++) if (core[p]) {
+				forRegion(p, [&](const long long& q) {
+					if (! core[q]) return;
+					if (! inRegion(q, p)) local.emplace_back(p, q);
+					else if (p < q) components.unite(p, q);
+				});
+			}
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+			links.insert(links.end(), local.begin(), local.end());
+		}
+		vector< long long > root(N), source(N);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (long long p = 0; p < N; p++) source[p] = root[p] = components.find(p);
+		for (auto it = links.begin(); it != links.end(); it++) {
+			it->first = root[it->first];
+			it->second = root[it->second];
+		}
+		links.erase(remove_if(links.begin(), links.end(),
+                          [](const pair< long long, long long >& l) { return l.first == l.second; }), links.end());
+		profiler.count("one_way_links", links.size());
+		// The links from each set, in compressed rows.
+		vector< long long > offsets(N + 1, 0), targets(links.size());
+		for (auto it = links.begin(); it != links.end(); it++) offsets[it->first + 1]++;
+		partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+		vector< long long > next(offsets.begin(), offsets.end() - 1);
+		for (auto it = links.begin(); it != links.end(); it++) targets[next[it->first]++] = it->second;
+		/*
+		 * Searches from each set in index order, without entering sets already reached. Whatever the
+		 * smallest set reaching a set reaches is searched before anything later, so the first search to
+		 * reach each set comes from its source, and every set and link is visited once.
+		 */
+		vector< char > reached(N, false);
+		vector< long long > stack;
+		for (long long p = 0; p < N; p++) if (core[p] && root[p] == p && ! reached[p]) {
+			reached[p] = true;
+			stack.push_back(p);
+			while (! stack.empty()) {
+				const long long q = stack.back();
+				stack.pop_back();
+				source[q] = p;
+				for (long long l = offsets[q]; l != offsets[q + 1]; l++) if (! reached[targets[l]]) {
+					reached[targets[l]] = true;
+					stack.push_back(targets[l]);
+				}
+			}
+		}
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (long long p = 0; p < N; p++) if (root[p] != p) source[p] = source[root[p]];
+		progress.increment(N);
+		return source;
+	}
+
+public:
+
+	DBSCAN(const NeighborGraph& graph,
+         const double& eps,
+         const unsigned int& minPts,
+         bool verbose,
+         Profiler& profiler = Profiler::none()) : graph{&graph},
+         								 eps{eps}, minPts{minPts}, N(graph.size()),
+         								 within(vector< kidxtype >(N)),
+         								 exceeded(vector< char >(N)),
+         								 core(vector< char >(N)),
+								         progress(Progress(3 * N, verbose)),
+								         profiler(profiler) {
+         	if (graph.neighborsPerVertex() < minPts) throw LargeVisError("Insufficient Neighbors.");
+       }
+
+	// The cluster of each point, numbered from 1, or 0 for noise.
+	vector< int > run() {
+		profiler.count("points", N);
+		profiler.phase("cores");
+		findCores();
+		profiler.phase("sources");
+		const vector< long long > source = findSources();
+		profiler.phase("labels");
+		// Clusters are numbered in the order of the core points that start them.
+		vector< int > clusterOf(N, 0);
+		int C = 0;
+		long long cores = 0;
+		for (long long p = 0; p < N; p++) if (core[p]) {
+			cores++;
+			if (source[p] == p) clusterOf[p] = ++C;
+		}
+		profiler.count("core_points", cores);
+		profiler.count("clusters", C);
+		vector< int > clusterAssignments(N);
+		int* assignments = clusterAssignments.data();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+		{
+			Profiler::Busy busy(profiler);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 4096) nowait
+#endif
+			for (long long p = 0; p < N; p++) {
+				if (core[p]) assignments[p] = clusterOf[source[p]];
+				else {
+					int cluster = 0;
+					for (auto it = graph->begin(p); it != graph->end(p); it++) {
+						const long long q = it->neighbor;
+						if (! core[q] || (cluster != 0 && clusterOf[source[q]] >= cluster) || ! inRegion(q, p)) continue;
+						cluster = clusterOf[source[q]];
+					}
+					assignments[p] = cluster;
+				}
+			}
+		}
+		progress.increment(N);
+		return clusterAssignments;
+	}
+};
+#endif
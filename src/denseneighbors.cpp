@@ -1,58 +1,153 @@
-#include "neighbors.h"
-#include "distance.h"
+#include "densesearch.h"
+#include <queue>
 
 using namespace Rcpp;
 using namespace std;
 using namespace arma;
 
-class DenseAnnoySearch : public AnnoySearch<arma::Mat<double>, arma::Col<double>> {
-protected:
-	virtual vec hyperplane(const ivec& indices) {
-		const vertexidxtype I = indices.n_elem;
-		vec direction = vec(I);
+/*
+ * Exact nearest-neighbor search for low-dimensional dense data, with a k-d tree laid out implicitly:
+ * the points are permuted so that every node covers a contiguous range of them, split at its middle
+ * on the dimension of greatest spread, and the children of node i are 2i + 1 and 2i + 2. Only the
+ * split of each node is stored, and the coordinates are copied in tree order so that leaves are
+ * scanned contiguously.
+ *
+ * Queries descend to the nearer child first and keep, for each dimension, the offset of the query
+ * from the cell of the current node, so that the squared distance to a far child is updated in
+ * constant time and the child skipped when it cannot hold a closer point. They are independent, and
+ * run in parallel.
+ */
+class KDTree {
+private:
+	const vertexidxtype N;
+	const dimidxtype D;
+	const vertexidxtype leafSize = 8;
+	vector< vertexidxtype > order; // Point at each position
+	vector< double > sorted; // Coordinates of the point at each position
+	vector< dimidxtype > splitDim;
+	vector< double > splitValue;
 
-		const vertexidxtype idx1 = sample(I);
-		vertexidxtype idx2 = sample(I - 1);
-		idx2 = (idx2 >= idx1) ? (idx2 + 1) % I : idx2;
+	typedef std::pair< distancetype, vertexidxtype > Candidate;
 
-		const vec x2 = data.col(indices[idx1]);
-		const vec x1 = data.col(indices[idx2]);
-			// Get hyperplane
-		const vec m =  (x1 + x2) / 2; // Base point of hyperplane
-		const vec d = x1 - x2;
-		const vec v =  d / as_scalar(norm(d, 2)); // unit vector
-
-		for (vertexidxtype i = 0; i != I; i++) {
-			const vec X = data.col(indices[i]);
-			direction[i] = dot((X - m), v);
+	void build(const mat& data, const vertexidxtype& node, const vertexidxtype& lo, const vertexidxtype& hi) {
+		if (hi - lo <= leafSize) return;
+		if (node >= (vertexidxtype) splitDim.size()) {
+			splitDim.resize(2 * node + 1);
+			splitValue.resize(2 * node + 1);
+		}
+		dimidxtype widest = 0;
+		double spread = -1;
+		for (dimidxtype d = 0; d != D; ++d) {
+			double lower = INFINITY, upper = -INFINITY;
+			for (vertexidxtype i = lo; i != hi; ++i) {
+				lower = min(lower, data(d, order[i]));
+				upper = max(upper, data(d, order[i]));
+			}
+			if (upper - lower > spread) {
+				spread = upper - lower;
+				widest = d;
+			}
 		}
-		return direction;
+		const vertexidxtype mid = lo + (hi - lo) / 2;
+		nth_element(order.begin() + lo, order.begin() + mid, order.begin() + hi,
+              [&data, widest](const vertexidxtype& a, const vertexidxtype& b) { return data(widest, a) < data(widest, b); });
+		splitDim[node] = widest;
+		splitValue[node] = data(widest, order[mid]);
+		build(data, 2 * node + 1, lo, mid);
+		build(data, 2 * node + 2, mid, hi);
 	}
-public:
-	DenseAnnoySearch(const mat& data, const kidxtype& K, Progress& p) : AnnoySearch(data, K, p) {}
-};
 
-class DenseEuclidean : public DenseAnnoySearch {
-protected:
-	virtual distancetype distanceFunction(const Col<double>& x_i, const Col<double>& x_j) const {
-		return relDist(x_i, x_j);
+	void search(const double* x,
+              const vertexidxtype& self,
+              const kidxtype& K,
+              const vertexidxtype& node,
+              const vertexidxtype& lo,
+              const vertexidxtype& hi,
+              double* offsets,
+              const double& bound,
+              priority_queue< Candidate >& nearest) const {
+		if (hi - lo <= leafSize) {
+			for (vertexidxtype i = lo; i != hi; ++i) if (order[i] != self) {
+				double d = 0;
+				for (dimidxtype k = 0; k != D; ++k) {
+					const double diff = sorted[i * D + k] - x[k];
+					d += diff * diff;
+				}
+				const Candidate candidate(d, order[i]);
+				if (nearest.size() < K) nearest.push(candidate);
+				else if (candidate < nearest.top()) {
+					nearest.pop();
+					nearest.push(candidate);
+				}
+			}
+			return;
+		}
+		const vertexidxtype mid = lo + (hi - lo) / 2;
+		const dimidxtype d = splitDim[node];
+		const double diff = x[d] - splitValue[node];
+		const bool left = diff < 0;
+		if (left) search(x, self, K, 2 * node + 1, lo, mid, offsets, bound, nearest);
+		else search(x, self, K, 2 * node + 2, mid, hi, offsets, bound, nearest);
+		const double old = offsets[d];
+		const double farBound = bound - old * old + diff * diff;
+		if (nearest.size() == K && farBound > nearest.top().first) return;
+		offsets[d] = diff;
+		if (left) search(x, self, K, 2 * node + 2, mid, hi, offsets, farBound, nearest);
+		else search(x, self, K, 2 * node + 1, lo, mid, offsets, farBound, nearest);
+		offsets[d] = old;
 	}
+
 public:
-	DenseEuclidean(const Mat<double>& data, const kidxtype& K, Progress& p) : DenseAnnoySearch(data, K, p) {}
-};
+	KDTree(const mat& data) : N(data.n_cols), D(data.n_rows),
+	                          order(vector< vertexidxtype >(N)),
+	                          sorted(vector< double >(N * D)) {
+		for (vertexidxtype i = 0; i != N; ++i) order[i] = i;
+		build(data, 0, 0, N);
+		for (vertexidxtype i = 0; i != N; ++i) for (dimidxtype d = 0; d != D; ++d) sorted[i * D + d] = data(d, order[i]);
+	}
 
-class DenseCosine : public DenseAnnoySearch {
-protected:
-	virtual distancetype distanceFunction(const Col<double>& x_i, const Col<double>& x_j) const {
-		return cosDist(x_i, x_j);
+	/*
+	 * The K nearest neighbors of each point, sorted by distance with ties broken by index, in the
+	 * columns of knns; -1 where there are fewer than K other points. If distances is not null, the
+	 * Euclidean distances to them are written in the same layout.
+	 */
+	void knn(const kidxtype& K, imat& knns, mat* distances, Progress& p, Profiler& profiler) const {
+		knns = imat(K, N);
+		knns.fill(-1);
+		if (distances != nullptr) distances->zeros(K, N);
+		ProgressMeter meter(p);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+		{
+			Profiler::Busy busy(profiler);
+			vector< double > offsets(D);
+			vector< Candidate > found;
+			priority_queue< Candidate > nearest;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
+			for (vertexidxtype i = 0; i < N; ++i) if (meter.increment()) {
+				const double* x = &sorted[i * D];
+				std::fill(offsets.begin(), offsets.end(), 0);
+				search(x, order[i], K, 0, 0, N, offsets.data(), 0, nearest);
+				found.clear();
+				for (; ! nearest.empty(); nearest.pop()) found.push_back(nearest.top());
+				const vertexidxtype point = order[i];
+				kidxtype k = 0;
+				for (auto it = found.rbegin(); it != found.rend(); ++it, ++k) {
+					knns(k, point) = it->second;
+					if (distances != nullptr) (*distances)(k, point) = sqrt(it->first);
+				}
+			}
+		}
+		meter.finish();
 	}
-public:
-	DenseCosine(const Mat<double>& data, const kidxtype& K, Progress& p) : DenseAnnoySearch(data, K, p) {}
 };
 
 
 // [[Rcpp::export]]
-arma::imat searchTrees(const int& threshold,
+SEXP searchTrees(const int& threshold,
                        const int& n_trees,
                        const int& K,
                        const int& maxIter,
@@ -64,24 +159,34 @@ arma::imat searchTrees(const int& threshold,
 #ifdef _OPENMP
 	checkCRAN(threads);
 #endif
-  const vertexidxtype N = data.n_cols;
-
-  Progress p((N * n_trees) + (3 * N) + (N * maxIter), verbose);
-
-  const mat dataMat = (distMethod.compare(string("Cosine")) == 0) ? normalise(data) : mat();
-
-	DenseAnnoySearch* annoy;
-	if (distMethod.compare(string("Cosine")) == 0) {
-		annoy = new DenseCosine(dataMat, K, p);
-	} else {
-		annoy = new DenseEuclidean(data, K, p);
-	}
+	Profiler profiler;
+	const long innerSeed = seed.isNotNull() ? (long) NumericVector(seed)[0] : 0;
+	const imat ret = denseNeighbors(data, distMethod, K, n_trees, threshold, maxIter,
+                                 seed.isNotNull() ? &innerSeed : nullptr, verbose, profiler);
+	return profiler.attach(ret);
+}
 
-	annoy->setSeed(seed);
-	annoy->trees(n_trees, threshold);
-	annoy->reduce();
-	annoy->exploreNeighborhood(maxIter);
-	imat ret = annoy->sortAndReturn();
-	delete annoy;
-	return ret;
+/*
+ * Exact search with a k-d tree, for data with few dimensions. Cosine distances are found as Euclidean
+ * distances between the normalized columns, which order the neighbors the same way.
+ */
+// [[Rcpp::export]]
+SEXP searchKDTree(const int& K,
+                  const arma::mat& data,
+                  const std::string& distMethod,
+                  Rcpp::Nullable< NumericVector > threads,
+                  bool verbose) {
+#ifdef _OPENMP
+	checkCRAN(threads);
+#endif
+	if (K < 1) throw Rcpp::exception("K must be at least 1.");
+	Profiler profiler;
+	profiler.count("vertices", data.n_cols);
+	Progress p(data.n_cols, verbose);
+	profiler.phase("tree");
+	const KDTree tree = (distMethod.compare(string("Cosine")) == 0) ? KDTree(normalise(data)) : KDTree(data);
+	profiler.phase("queries");
+	imat knns;
+	tree.knn(K, knns, nullptr, p, profiler);
+	return profiler.attach(knns);
 }
@@ -0,0 +1,37 @@
+#include "densesearch.h"
+
+imat denseNeighbors(const mat& data,
+                    const std::string& distMethod,
+                    const kidxtype& K,
+                    const unsigned int& n_trees,
+                    const unsigned int& threshold,
+                    const unsigned int& maxIter,
+                    const long* seed,
+                    const bool& verbose,
+                    Profiler& profiler) {
+  const vertexidxtype N = data.n_cols;
+
+  Progress p((N * n_trees) + (3 * N) + (N * maxIter), verbose);
+  profiler.count("vertices", N);
+
+  const mat dataMat = (distMethod.compare(string("Cosine")) == 0) ? normalise(data) : mat();
+
+	DenseAnnoySearch* annoy;
+	if (distMethod.compare(string("Cosine")) == 0) {
+		annoy = new DenseCosine(dataMat, K, p, profiler);
+	} else {
+		annoy = new DenseEuclidean(data, K, p, profiler);
+	}
+
+	annoy->setSeed(seed);
+	profiler.phase("trees");
+	annoy->trees(n_trees, threshold);
+	profiler.phase("reduce");
+	annoy->reduce();
+	profiler.phase("explore");
+	annoy->exploreNeighborhood(maxIter);
+	profiler.phase("sort");
+	imat ret = annoy->sortAndReturn();
+	delete annoy;
+	return ret;
+}
@@ -0,0 +1,69 @@
+#ifndef _LARGEVISDENSESEARCH
+#define _LARGEVISDENSESEARCH
+#include "neighbors.h"
+#include "distance.h"
+
+using namespace std;
+using namespace arma;
+
+class DenseAnnoySearch : public AnnoySearch<arma::Mat<double>, arma::Col<double>> {
+protected:
+	virtual vec hyperplane(const ivec& indices) {
+		const vertexidxtype I = indices.n_elem;
+		vec direction = vec(I);
+
+		const vertexidxtype idx1 = sample(I);
+		vertexidxtype idx2 = sample(I - 1);
+		idx2 = (idx2 >= idx1) ? (idx2 + 1) % I : idx2;
+
+		const vec x2 = data.col(indices[idx1]);
+		const vec x1 = data.col(indices[idx2]);
+			// Get hyperplane
+		const vec m =  (x1 + x2) / 2; // Base point of hyperplane
+		const vec d = x1 - x2;
+		const vec v =  d / as_scalar(norm(d, 2)); // unit vector
+
+		for (vertexidxtype i = 0; i != I; i++) {
+			const vec X = data.col(indices[i]);
+			direction[i] = dot((X - m), v);
+		}
+		return direction;
+	}
+public:
+	DenseAnnoySearch(const mat& data, const kidxtype& K, Progress& p, Profiler& profiler) : AnnoySearch(data, K, p, profiler) {}
+};
+
+class DenseEuclidean : public DenseAnnoySearch {
+protected:
+	virtual distancetype distanceFunction(const Col<double>& x_i, const Col<double>& x_j) const {
+		return relDist(x_i, x_j);
+	}
+public:
+	DenseEuclidean(const Mat<double>& data, const kidxtype& K, Progress& p, Profiler& profiler) : DenseAnnoySearch(data, K, p, profiler) {}
+};
+
+class DenseCosine : public DenseAnnoySearch {
+protected:
+	virtual distancetype distanceFunction(const Col<double>& x_i, const Col<double>& x_j) const {
+		return cosDist(x_i, x_j);
+	}
+public:
+	DenseCosine(const Mat<double>& data, const kidxtype& K, Progress& p, Profiler& profiler) : DenseAnnoySearch(data, K, p, profiler) {}
+};
+
+/*
+ * The K approximate nearest neighbors of each column of data, by Euclidean distance or, if
+ * distMethod is "Cosine", cosine distance, from n_trees random projection trees with leaves of at
+ * most threshold points and maxIter rounds of neighborhood exploration. Each column of the result
+ * holds a point's neighbors, 0-indexed, padded with -1.
+ */
+imat denseNeighbors(const mat& data,
+                    const std::string& distMethod,
+                    const kidxtype& K,
+                    const unsigned int& n_trees,
+                    const unsigned int& threshold,
+                    const unsigned int& maxIter,
+                    const long* seed,
+                    const bool& verbose,
+                    Profiler& profiler = Profiler::none());
+#endif
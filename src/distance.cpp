@@ -2,42 +2,6 @@
 #include "distance.h"
 #include <progress.hpp>
 
-distancetype relDist(const arma::vec& i, const arma::vec& j) {
-  const dimidxtype D = i.n_elem;
-  distancetype cnt = 0;
-  for (dimidxtype idx = 0; idx < D; idx++) cnt += ((i[idx] - j[idx]) * (i[idx] - j[idx]));
-  return cnt;
-}
-// Vanilla euclidean
-distancetype dist(const arma::vec& i, const arma::vec& j) {
-  return sqrt(relDist(i,j));
-}
-
-// Vanilla cosine distance calculation
-distancetype cosDist(const arma::vec& i, const arma::vec& j) {
-  const dimidxtype D = i.n_elem;
-	distancetype pp = 0, qq = 0, pq = 0;
-  for (dimidxtype d = 0; d < D; d++) {
-    pp += (i[d]) * (i[d]);
-    qq += (j[d]) * (j[d]);
-    pq += (i[d]) * (j[d]);
-  }
-  distancetype ppqq = pp * qq;
-  if (ppqq > 0) return 2.0 - 2.0 * pq / sqrt(ppqq);
-  else return 2.0; // cos is 0
-}
-// Versions of the distance functions for finding the neighbors
-// of sparse matrices.  Not optimized.
-distancetype sparseDist(const sp_mat& i, const sp_mat& j) {
-  return as_scalar(sqrt(sum(square(i - j))));
-}
-distancetype sparseCosDist(const sp_mat& i, const sp_mat& j) {
-  return 2.0 - 2.0 * (as_scalar((dot(i,j)) / as_scalar(norm(i,2) * norm(j,2))));
-}
-distancetype sparseRelDist(const sp_mat& i, const sp_mat& j) {
-  return as_scalar(sum(square(i - j)));
-}
-
 /*
  * Fast calculation of pairwise distances with the result stored in a pre-allocated vector.
  */
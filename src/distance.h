@@ -1,14 +1,46 @@
+#ifndef _LARGEVISDISTANCE
+#define _LARGEVISDISTANCE
 #include "largeVis.h"
-#include <Rcpp.h>
 
+inline distancetype relDist(const arma::vec& i, const arma::vec& j) {
+  const dimidxtype D = i.n_elem;
+  distancetype cnt = 0;
+  for (dimidxtype idx = 0; idx < D; idx++) cnt += ((i[idx] - j[idx]) * (i[idx] - j[idx]));
+  return cnt;
+}
+// Vanilla euclidean
+inline distancetype dist(const arma::vec& i, const arma::vec& j) {
+  return sqrt(relDist(i,j));
+}
+
+// Vanilla cosine distance calculation
+inline distancetype cosDist(const arma::vec& i, const arma::vec& j) {
+  const dimidxtype D = i.n_elem;
+	distancetype pp = 0, qq = 0, pq = 0;
+  for (dimidxtype d = 0; d < D; d++) {
+    pp += (i[d]) * (i[d]);
+    qq += (j[d]) * (j[d]);
+    pq += (i[d]) * (j[d]);
+  }
+  distancetype ppqq = pp * qq;
+  if (ppqq > 0) return 2.0 - 2.0 * pq / sqrt(ppqq);
+  else return 2.0; // cos is 0
+}
+// Versions of the distance functions for finding the neighbors
+// of sparse matrices.  Not optimized.
+inline distancetype sparseDist(const arma::sp_mat& i, const arma::sp_mat& j) {
+  return as_scalar(sqrt(sum(square(i - j))));
+}
+inline distancetype sparseCosDist(const arma::sp_mat& i, const arma::sp_mat& j) {
+  return 2.0 - 2.0 * (as_scalar((dot(i,j)) / as_scalar(norm(i,2) * norm(j,2))));
+}
+inline distancetype sparseRelDist(const arma::sp_mat& i, const arma::sp_mat& j) {
+  return as_scalar(sum(square(i - j)));
+}
+
+#ifndef LARGEVIS_STANDALONE
 using namespace Rcpp;
 
-distancetype dist(const arma::vec& i, const arma::vec& j);
-distancetype relDist(const arma::vec& i, const arma::vec& j);
-distancetype cosDist(const arma::vec& i, const arma::vec& j);
-distancetype sparseDist(const arma::sp_mat& i, const arma::sp_mat& j);
-distancetype sparseRelDist(const arma::sp_mat& i, const arma::sp_mat& j);
-distancetype sparseCosDist(const arma::sp_mat& i, const arma::sp_mat& j);
 
 // Exported distance functions for high dimensional space
 arma::vec fastDistance(const NumericVector is,
@@ -35,3 +67,5 @@ arma::vec fastSDistance(const arma::vec& is,
                         const arma::vec& x,
                         const std::string& distMethod,
                         bool verbose);
+#endif
+#endif
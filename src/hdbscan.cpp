@@ -1,27 +1,124 @@
 #include "largeVis.h"
 #include "hdbscan.h"
 #include "primsalgorithm.h"
+#include "spatialgrid.h"
+#include <memory>
 //#define DEBUG
 
+using namespace Rcpp;
+
+static List hierarchyList(const HierarchyReport& hierarchy) {
+	return  List::create(Named("nodemembership") = IntegerVector(hierarchy.nodeMembership.begin(), hierarchy.nodeMembership.end()),
+                      Named("lambda") = NumericVector(hierarchy.lambdas.begin(), hierarchy.lambdas.end()),
+                      Named("parent") = IntegerVector(hierarchy.clusterParent.begin(), hierarchy.clusterParent.end()),
+                      Named("stability") = NumericVector(hierarchy.clusterStability.begin(), hierarchy.clusterStability.end()),
+                      Named("selected") = LogicalVector(hierarchy.clusterSelected.begin(), hierarchy.clusterSelected.end()),
+                      Named("lambda_birth") = NumericVector(hierarchy.lambdaBirth.begin(), hierarchy.lambdaBirth.end()),
+                    	Named("lambda_death") = NumericVector(hierarchy.lambdaDeath.begin(), hierarchy.lambdaDeath.end()),
+                      Named("coredistances") = wrap(hierarchy.coreDistances));
+}
+
+static List hdbscanList(const NeighborGraph& graph,
+                        const int& K,
+                        const int& minPts,
+                        const std::string& mstMethod,
+                        const bool& membership,
+                        const bool verbose,
+                        Profiler& profiler) {
+	const HDBSCANResult result = hdbscanGraph(graph, K, minPts, mstMethod, membership, verbose, profiler);
+	const HDBSCANClustering& clustering = result.clustering;
+	List ret = List::create(Named("clusters") = IntegerVector(clustering.clusters.begin(), clustering.clusters.end()),
+                          Named("lambdas") = NumericVector(clustering.lambdas.begin(), clustering.lambdas.end()),
+                          Named("probabilities") = NumericVector(clustering.probabilities.begin(), clustering.probabilities.end()),
+                          Named("glosh") = NumericVector(clustering.glosh.begin(), clustering.glosh.end()),
+                          Named("tree") = IntegerVector(result.tree.begin(), result.tree.end()),
+                          Named("hierarchy") = hierarchyList(clustering.hierarchy));
+	if (membership) ret["membership"] = result.membership;
+	return ret;
+}
+
 // [[Rcpp::export]]
-List hdbscanc(const arma::sp_mat& edges,
+SEXP hdbscanc(const arma::sp_mat& edges,
               const IntegerMatrix& neighbors,
               const int& K,
               const int& minPts,
+              const std::string& mstMethod,
+              const bool& membership,
               const Rcpp::Nullable<Rcpp::NumericVector> threads,
               const bool verbose) {
 #ifdef _OPENMP
 	checkCRAN(threads);
 #endif
-	HDBSCAN object = HDBSCAN(edges.n_cols, verbose);
-	// 1 N
-	IntegerVector tree = object.build(K, edges, minPts, neighbors); // 4N
-	IntegerVector clusters = IntegerVector(edges.n_cols);
-	NumericVector lambdas = NumericVector(edges.n_cols);
-	object.condenseAndExtract(minPts, INTEGER(clusters), REAL(lambdas)); // 3N
-	List hierarchy = object.getHierarchy();
-	return List::create(Named("clusters") = clusters,
-                      Named("lambdas") = lambdas,
-                      Named("tree") = IntegerVector(tree),
-                      Named("hierarchy") = hierarchy);
+	Profiler profiler;
+	profiler.phase("neighbor graph");
+	const NeighborGraph graph = NeighborGraph(edges, neighbors);
+	return profiler.attach(hdbscanList(graph, K, minPts, mstMethod, membership, verbose, profiler));
+}
+
+/*
+ * The same, for points given by their coordinates in up to three dimensions, on the exact graph of
+ * each point's graphK nearest neighbors found with a spatial grid.
+ */
+// [[Rcpp::export]]
+SEXP hdbscan_coords(const arma::mat& coords,
+                    const int& graphK,
+                    const int& K,
+                    const int& minPts,
+                    const std::string& mstMethod,
+                    const bool& membership,
+                    const Rcpp::Nullable<Rcpp::NumericVector> threads,
+                    const bool verbose) {
+#ifdef _OPENMP
+	checkCRAN(threads);
+#endif
+	Profiler profiler;
+	profiler.phase("neighbor graph");
+	const NeighborGraph graph = gridKnnGraph(coords, graphK);
+	return profiler.attach(hdbscanList(graph, K, minPts, mstMethod, membership, verbose, profiler));
+}
+
+/*
+ * Builds a hierarchy for each K from the same neighbor graph, in parallel, and then condenses and
+ * extracts each hierarchy for every minPts.
+ */
+// [[Rcpp::export]]
+List hdbscan_sweepc(const arma::sp_mat& edges,
+                    const IntegerMatrix& neighbors,
+                    const IntegerVector& K,
+                    const IntegerVector& minPts,
+                    const std::string& mstMethod,
+                    const Rcpp::Nullable<Rcpp::NumericVector> threads,
+                    const bool verbose) {
+#ifdef _OPENMP
+	checkCRAN(threads);
+#endif
+	const NeighborGraph graph = NeighborGraph(edges, neighbors);
+	for (auto it = K.begin(); it != K.end(); ++it) HDBSCAN::checkInputs(graph, *it, mstMethod);
+	const int Ks = K.size();
+	Progress p((3 + 3 * minPts.size()) * Ks * edges.n_cols, verbose);
+	vector< unique_ptr< HDBSCAN > > objects;
+	for (int k = 0; k != Ks; ++k) objects.emplace_back(new HDBSCAN(edges.n_cols, p));
+	vector< vector< arma::uword > > trees(Ks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int k = 0; k < Ks; ++k) trees[k] = objects[k]->build(K[k], graph, mstMethod); // 4N per K
+	const vector< unsigned int > minPtsVector(minPts.begin(), minPts.end());
+	List treeList = List(Ks), sweepList = List(Ks);
+	for (int k = 0; k != Ks; ++k) {
+		treeList[k] = IntegerVector(trees[k].begin(), trees[k].end());
+		const vector< HDBSCANClustering > sweeps = objects[k]->sweep(minPtsVector); // 3N per minPts
+		List clusterings = List(sweeps.size());
+		for (vector< HDBSCANClustering >::size_type m = 0; m != sweeps.size(); ++m) {
+			const HDBSCANClustering& clustering = sweeps[m];
+			clusterings[m] = List::create(Named("clusters") = IntegerVector(clustering.clusters.begin(), clustering.clusters.end()),
+                                    Named("lambdas") = NumericVector(clustering.lambdas.begin(), clustering.lambdas.end()),
+                                    Named("probabilities") = NumericVector(clustering.probabilities.begin(), clustering.probabilities.end()),
+                                    Named("glosh") = NumericVector(clustering.glosh.begin(), clustering.glosh.end()),
+                                    Named("hierarchy") = hierarchyList(clustering.hierarchy));
+		}
+		sweepList[k] = clusterings;
+	}
+	return List::create(Named("trees") = treeList,
+                      Named("sweeps") = sweepList);
 }
@@ -1,117 +1,166 @@
-#include <RcppArmadillo.h>
+#ifndef _LARGEVISHDBSCAN
+#define _LARGEVISHDBSCAN
+#include "largeVis.h"
 #ifdef _OPENMP
 #include <omp.h>
 #endif
 #include "progress.hpp"
+#include "neighborgraph.h"
+#include "profiler.h"
 
-using namespace Rcpp;
 using namespace arma;
 using namespace std;
 //#define DEBUG
 //#define DEBUG2
 
-class HDCluster {
+/*
+ * The single-linkage tree, and after condense() the condensed tree, stored as flat arrays indexed
+ * by node. Nodes 0 to N - 1 are the points; each merge appends a node, so children always have
+ * lower indices than their parents, and the tree can be processed bottom-up or top-down by
+ * walking the indices in order.
+ *
+ * Condensing does not move nodes. A node that is folded into an ancestor is marked absorbed, and
+ * its parent entry then points at the node that absorbed it. The points that fall out of a cluster
+ * are the leaves whose chain of absorbing nodes ends at that cluster.
+ */
+class ClusterTree {
 private:
-	HDCluster* parent = nullptr;
-
-	HDCluster* right = nullptr;
-
-	list< std::pair<arma::uword, double >> fallenPoints; // Points that leave cluster betweeen top and split
-	double lambda_birth = 0; // 1 / Distance at which splits from parent cluster
-	double lambda_death = INFINITY; // 1 / Distance at which cluster splits
-	double sum_lambda_p = 0; // sum of lambda_p for all points in cluster, fallen and split
-	double stability = 0;
-	bool selected = false;
-
-	void deselect();
-
-	void mergeUp();
-	void innerCondense(const unsigned int minPts);
-	void condenseSingleton();
-	void condenseTooSmall();
-	void extract( int* clusters, double* lambas, int& selectedClusterCnt, int currentSelectedCluster, Progress& p) const;
-	void reportHierarchy(
-							 int& clusterCnt,
-               vector<int>& nodeMembership, // The clusterid of the immediate parent for each point
-               vector<double>& lambdas,
-               vector<int>& clusterParent,
-               vector<bool>& clusterSelected,
-               vector<double>& clusterStability,
-               vector<double>& lambdaBirth,
-               vector<double>& lambdaDeath,
-               const int parentCluster) const;
+	const arma::uword N;
+	const arma::uword NONE;
+
+	vector< arma::uword > left; // The smaller child
+	vector< arma::uword > right;
+	vector< arma::uword > parent; // Parent in the condensed tree, or the absorbing node if absorbed
+	vector< arma::uword > sz; // Size at top of cluster
+	vector< arma::uword > fallenCount; // Points that leave cluster between top and split
+	vector< double > lambdaBirth; // 1 / Distance at which splits from parent cluster
+	vector< double > lambdaDeath; // 1 / Distance at which cluster splits
+	vector< double > sumLambdaP; // sum of lambda_p for all points in cluster, fallen and split
+	vector< double > stability;
+	vector< bool > absorbed;
+	vector< bool > selected;
+	vector< arma::uword > roots;
+
+	void absorb(const arma::uword& node, const arma::uword& child);
+	void condenseTooSmall(const arma::uword& node);
+	void condenseSingleton(const arma::uword& node);
+	void innerCondense(const arma::uword& node, const unsigned int& minPts);
+	// The surviving cluster each point fell out of, or NONE if the point never fell.
+	vector< arma::uword > fallenFrom() const;
+	// For each node, the number of condensed clusters in its subtree, counting those for which count is true.
+	template<class Count>
+	vector< arma::uword > subtreeCounts(Count count) const;
+	// Where each root's subtree starts in a numbering of the given per-node counts in root order.
+	vector< arma::uword > rootOffsets(const vector< arma::uword >& counts) const;
 
 public:
-	HDCluster* left = nullptr;
-	const arma::uword sz; // Size at top of cluster
-	const arma::uword id;
-	arma::uword rank = 0;
-
-	void newparent(vector<HDCluster*>& points, HDCluster* newparent);
-	~HDCluster();
-	explicit HDCluster(const arma::uword& id);
-
-	HDCluster* getRoot();
-
-	HDCluster(HDCluster* a, HDCluster* b, const arma::uword& id, const double& d);
+	explicit ClusterTree(const arma::uword& N);
 
-	void condense(const unsigned int minPts, unsigned int level);
-	double determineStability(const unsigned int& minPts, Progress& p);
-	void determineSubStability(const unsigned int& minPts, Progress& p);
+	arma::uword merge(const arma::uword& a, const arma::uword& b, const double& d);
+	void setRoots(const vector< arma::uword >& newRoots);
 
+	void condense(const unsigned int& minPts, Progress& p);
+	void determineStability(const unsigned int& minPts, Progress& p);
 	void extract(
 			int* clusters,
-			double* lambdas, // An N * 2 array where for each point n * 2 is the cluster id for the point and n * 2 + 1 is lambda_p.
-			int& selectedClusterCnt,
+			double* lambdas, // For each point, lambda_p.
+			double* probabilities,
+			double* glosh,
 			Progress& p
 	) const;
 
+	// For each point, a row of its degree of membership in each selected cluster.
+	arma::mat membershipVectors(const NeighborGraph& graph, const int* clusters, Progress& p) const;
+
 	void reportHierarchy(
-			int& clusterCnt,
 			vector<int>& nodeMembership, // The clusterid of the immediate parent for each point
 			vector<double>& lambdas,
 			vector<int>& clusterParent,
-			vector<bool>& clusterSelected,
+			vector<int>& clusterSelected,
 			vector<double>& clusterStability,
 			vector<double>& lambdaBirth,
-			vector<double>& lambdaDeath);
+			vector<double>& lambdaDeath) const;
 };
 
-template<typename Tval>
-struct MyTemplatePointerHash1 {
-	size_t operator()(const Tval* val) const {
-		static const size_t shift = (size_t)log2(1 + sizeof(Tval));
-		return (size_t)(val) >> shift;
+// The condensed hierarchy, in the form returned to R, with the core distances it was built from.
+struct HierarchyReport {
+	vector<int> nodeMembership;
+	vector<double> lambdas;
+	vector<int> clusterParent;
+	vector<int> clusterSelected;
+	vector<double> clusterStability;
+	vector<double> lambdaBirth;
+	vector<double> lambdaDeath;
+	vector<double> coreDistances;
+
+	explicit HierarchyReport(const arma::uword& N) : nodeMembership(N), lambdas(N) {}
+	void report(const ClusterTree& tree) {
+		tree.reportHierarchy(nodeMembership, lambdas, clusterParent, clusterSelected,
+                         clusterStability, lambdaBirth, lambdaDeath);
 	}
 };
 
-typedef unordered_map<arma::uword, HDCluster*> Rootset;
+// The clusters extracted from one condensed tree, numbered from 1 with NA_INTEGER for noise.
+struct HDBSCANClustering {
+	vector<int> clusters;
+	vector<double> lambdas;
+	vector<double> probabilities;
+	vector<double> glosh;
+	HierarchyReport hierarchy;
+
+	explicit HDBSCANClustering(const arma::uword& N) : clusters(N, 0), lambdas(N, 0), probabilities(N, 0),
+                                                     glosh(N, 0), hierarchy(N) {}
+};
 
 class HDBSCAN {
 private:
   arma::uword N;
-  Progress p;
-  Rootset roots;
+  Progress& p;
+  Profiler& profiler;
+  ClusterTree tree;
   double* coreDistances;
 
   void buildHierarchy(const vector<pair<double, arma::uword>>& mergeSequence,
-                      const unsigned int& minPts,
                       const arma::uword* minimum_spanning_tree);
   void determineStability(const unsigned int& minPts);
-  void extractClusters(int* clusters, double* lambdas);
+  void extractClusters(int* clusters, double* lambdas, double* probabilities, double* glosh);
   void condense(const unsigned int& minPts);
-  void condense(const unsigned int& minPts, vector<HDCluster*>& points);
+  void report(const ClusterTree& condensed, HierarchyReport& hierarchy) const;
 public:
-	HDBSCAN(const arma::uword& N, const bool& verbose);
+	// Each build counts 3N against the progress bar, and each condense and extract another 3N.
+	// A profiler is only given to objects built one at a time, since it records each phase of the run.
+	HDBSCAN(const arma::uword& N, Progress& p, Profiler& profiler = Profiler::none());
 	~HDBSCAN();
 
-	void makeCoreDistances(	const sp_mat& edges,
-                          const IntegerMatrix& neighbors,
-                          const int& K);
-	IntegerVector build( 		const unsigned int& K,
-                        	const sp_mat& edges,
-                        	const unsigned int& minPts,
-                        	const IntegerMatrix& neighbors);
-	void condenseAndExtract(const unsigned int& minPts, int* clusters, double* lambdas);
-	Rcpp::List getHierarchy() const;
-};
\ No newline at end of file
+	// Throw if the graph or method cannot support build(), so that build() itself never throws.
+	static void checkInputs(const NeighborGraph& graph, const unsigned int& K, const std::string& mstMethod);
+	void makeCoreDistances(const NeighborGraph& graph, const unsigned int& K);
+	// Returns the minimum spanning tree, with NA_INTEGER for the roots.
+	vector< arma::uword > build(const unsigned int& K,
+                             const NeighborGraph& graph,
+                             const std::string& mstMethod);
+	void condenseAndExtract(const unsigned int& minPts, int* clusters, double* lambdas,
+	                        double* probabilities, double* glosh);
+	// Condenses and extracts a copy of the tree for each value of minPts, leaving the tree itself intact.
+	vector< HDBSCANClustering > sweep(const vector< unsigned int >& minPts);
+	arma::mat membershipVectors(const NeighborGraph& graph, const int* clusters);
+	HierarchyReport getHierarchy() const;
+};
+
+// One clustering of a graph, with the minimum spanning tree it came from and, if asked for, the membership vectors.
+struct HDBSCANResult {
+	vector< arma::uword > tree;
+	HDBSCANClustering clustering;
+	arma::mat membership;
+
+	explicit HDBSCANResult(const arma::uword& N) : clustering(N) {}
+};
+
+HDBSCANResult hdbscanGraph(const NeighborGraph& graph,
+                           const int& K,
+                           const int& minPts,
+                           const std::string& mstMethod,
+                           const bool& membership,
+                           const bool& verbose,
+                           Profiler& profiler = Profiler::none());
+#endif
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "largeVis.h"
+#include <vector>
+#include <algorithm>
+
+using namespace Rcpp;
+using namespace std;
+
+/*
+ * Selects clusters again from the condensed hierarchy of an existing hdbscan clustering, and relabels
+ * the points, without rebuilding or condensing the tree. Every pass is a single walk over the clusters
+ * or over the points.
+ *
+ * Clusters are numbered in the pre-order of the hierarchy, so every parent precedes its children, and
+ * roots are the only clusters with a lambda_birth of zero. The reported stability of a cluster that was
+ * not selected by excess of mass is the sum of its children's, so the excess-of-mass selection can be
+ * recovered from the stabilities whatever selection the hierarchy currently records.
+ */
+class HDBSCANExtractor {
+private:
+	const IntegerVector clusterParent;
+	const NumericVector stability;
+	const LogicalVector selected;
+	const NumericVector lambdaBirth;
+	const int M;
+	bool singleRoot;
+	vector< bool > hasChildren;
+	vector< double > childStability;
+
+	inline bool isRoot(const int& c) const {
+		return lambdaBirth[c] == 0;
+	}
+
+	// Whether the search upwards from a cluster stops there, whatever epsilon.
+	inline bool keeps(const int& c) const {
+		return isRoot(c) || (singleRoot && isRoot(clusterParent[c]));
+	}
+
+	/*
+	 * A root without children is a cluster only if it is large enough, and its selection never
+	 * changes, so it is taken from the hierarchy. Every other leaf is large enough.
+	 */
+	inline bool eligibleLeaf(const int& c) const {
+		return isRoot(c) ? (bool) selected[c] : true;
+	}
+
+public:
+	HDBSCANExtractor(const IntegerVector& clusterParent,
+                   const NumericVector& stability,
+                   const LogicalVector& selected,
+                   const NumericVector& lambdaBirth) :
+		clusterParent{clusterParent}, stability{stability}, selected{selected}, lambdaBirth{lambdaBirth},
+		M(clusterParent.size()), hasChildren(vector< bool >(M, false)), childStability(vector< double >(M, 0)) {
+		int roots = 0;
+		// Children are visited in the order their stabilities were summed.
+		for (int c = 0; c != M; ++c) {
+			if (isRoot(c)) ++roots;
+			else {
+				hasChildren[clusterParent[c]] = true;
+				childStability[clusterParent[c]] += stability[c];
+			}
+		}
+		singleRoot = roots == 1;
+	}
+
+	// The clusters chosen by the method, before clusters beneath chosen clusters are dropped.
+	vector< bool > choose(const std::string& method) const {
+		vector< bool > chosen(M, false);
+		const bool leaf = method.compare(string("leaf")) == 0;
+		for (int c = 0; c != M; ++c) {
+			if (! hasChildren[c]) chosen[c] = eligibleLeaf(c);
+			else if (! leaf && ! (singleRoot && isRoot(c))) chosen[c] = stability[c] > childStability[c];
+		}
+		return chosen;
+	}
+
+	/*
+	 * Replaces each chosen cluster that split off at a distance below epsilon with its nearest ancestor
+	 * that split off above epsilon, so that micro-clusters merge back into the cluster they came
+	 * from. With a single root, the root itself is never chosen.
+	 *
+	 * The comparisons follow the Python hdbscan library: a chosen cluster that split off at exactly
+	 * epsilon is kept, but an ancestor that split off at exactly epsilon is passed over.
+	 */
+	void mergeBelow(const double& epsilon, vector< bool >& chosen) const {
+		vector< int > top(M);
+		for (int c = 0; c != M; ++c) {
+			if (keeps(c) || 1 / lambdaBirth[c] > epsilon) top[c] = c;
+			else top[c] = top[clusterParent[c]];
+		}
+		vector< bool > merged(M, false);
+		for (int c = 0; c != M; ++c) if (chosen[c]) {
+			merged[(keeps(c) || 1 / lambdaBirth[c] >= epsilon) ? c : top[clusterParent[c]]] = true;
+		}
+		chosen.swap(merged);
+	}
+
+	// Drops every chosen cluster beneath another, and numbers those left from 1 in order.
+	int label(vector< bool >& chosen, vector< int >& labelOf) const {
+		vector< bool > covered(M, false);
+		labelOf.assign(M, NA_INTEGER);
+		int labels = 0;
+		for (int c = 0; c != M; ++c) {
+			if (! isRoot(c)) {
+				covered[c] = covered[clusterParent[c]] || chosen[clusterParent[c]];
+				labelOf[c] = labelOf[clusterParent[c]];
+			}
+			if (covered[c]) chosen[c] = false;
+			if (chosen[c]) labelOf[c] = ++labels;
+		}
+		return labels;
+	}
+};
+
+/*
+ * Points that never fell out of a cluster have a lambda of zero and keep the label 0, as they do
+ * when clusters are first extracted.
+ */
+// [[Rcpp::export]]
+List hdbscan_extractc(const IntegerVector& nodeMembership,
+                      const NumericVector& lambdas,
+                      const IntegerVector& clusterParent,
+                      const NumericVector& stability,
+                      const LogicalVector& selected,
+                      const NumericVector& lambdaBirth,
+                      const std::string& method,
+                      const double& epsilon,
+                      const Rcpp::Nullable<Rcpp::NumericVector> threads) {
+#ifdef _OPENMP
+	checkCRAN(threads);
+#endif
+	if (method.compare(string("eom")) != 0 && method.compare(string("leaf")) != 0) {
+		throw Rcpp::exception("Unknown cluster selection method.");
+	}
+	if (! (epsilon >= 0)) throw Rcpp::exception("epsilon must not be negative.");
+	const HDBSCANExtractor extractor(clusterParent, stability, selected, lambdaBirth);
+	vector< bool > chosen = extractor.choose(method);
+	if (epsilon > 0) extractor.mergeBelow(epsilon, chosen);
+	vector< int > labelOf;
+	const int labels = extractor.label(chosen, labelOf);
+
+	const int N = nodeMembership.size();
+	IntegerVector clusters(N);
+	NumericVector probabilities(N);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int n = 0; n < N; ++n) clusters[n] = (lambdas[n] == 0) ? 0 : labelOf[nodeMembership[n]];
+	vector< double > minLambda(labels + 1, INFINITY), maxLambda(labels + 1, -INFINITY);
+	for (int n = 0; n != N; ++n) if (clusters[n] != NA_INTEGER) {
+		minLambda[clusters[n]] = min(minLambda[clusters[n]], (double) lambdas[n]);
+		maxLambda[clusters[n]] = max(maxLambda[clusters[n]], (double) lambdas[n]);
+	}
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (int n = 0; n < N; ++n) {
+		if (clusters[n] == NA_INTEGER) probabilities[n] = lambdas[n];
+		else probabilities[n] = (lambdas[n] - minLambda[clusters[n]]) / (maxLambda[clusters[n]] - minLambda[clusters[n]]);
+	}
+	return List::create(Named("clusters") = clusters,
+                      Named("probabilities") = probabilities,
+                      Named("selected") = LogicalVector(chosen.begin(), chosen.end()));
+}
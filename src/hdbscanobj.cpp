@@ -1,183 +1,183 @@
 #include "largeVis.h"
 #include "hdbscan.h"
 #include "primsalgorithm.h"
+#include "boruvka.h"
+#include "unionfind.h"
+#include "progressmeter.h"
+#include <numeric>
 //#define DEBUG
 
 void HDBSCAN::condense(const unsigned int& minPts) {
-#ifdef _OPENMP
-#pragma omp parallel
-{
-	const int level = std::log2(omp_get_max_threads()) + 1;
-#pragma omp master
-#else
-	const int level = 0;
-#endif
-	for (auto it = roots.begin(); it != roots.end(); ++it) {
-		HDCluster* thisone = it->second;
-		thisone->condense(minPts, level);
-		p.increment(thisone->sz);
-	}
-#ifdef _OPENMP
-}
-#endif
-}
-
-void HDBSCAN::condense(const unsigned int& minPts, vector<HDCluster*>& points) {
-	//	set<HDCluster*> theseroots;
-	//	std::for_each(points.begin(), points.end(), [&theseroots](HDCluster* it) {theseroots.insert(it->getRoot());});
-#ifdef _OPENMP
-#pragma omp parallel
-{
-	const int level = std::log2(omp_get_max_threads()) + 1;
-#else
-	const int level = 0;
-#endif
-	{
-#ifdef _OPENMP
-#pragma omp master
-#endif
-		for (auto it = roots.begin(); it != roots.end(); ++it) {
-			HDCluster* thisone = it->second;
-			if (thisone->left != nullptr)
-#ifdef _OPENMP
-#pragma omp task
-#endif
-			{
-				thisone->condense(minPts, level);
-				thisone->newparent(points, thisone);
-			}
-		}
-	}
-#ifdef _OPENMP
-}
-#endif
+	tree.condense(minPts, p);
 }
 
-
 void HDBSCAN::determineStability(const unsigned int& minPts) {
-	if (roots.size() == 1) {
-		HDCluster& root = *(roots.begin()->second);
-		root.determineSubStability(minPts, p);
-	} else {
-		for (auto it = roots.begin(); it != roots.end(); ++it) {
-			HDCluster& thisone = *(it->second);
-			thisone.determineStability(minPts, p);
-			p.increment(thisone.sz);
-		}
-	}
+	tree.determineStability(minPts, p);
 }
 
-
-
-
-
-
-void HDBSCAN::extractClusters(int* clusters, double* lambdas) {
-	int selectedClusterCnt = 1; //NA_INTEGER;
-	for (auto it = roots.begin(); it != roots.end(); ++it) {
-		HDCluster& thisone = *(it->second);
-		thisone.extract(clusters, lambdas, selectedClusterCnt, p);
-		p.increment(thisone.sz);
-	}
+void HDBSCAN::extractClusters(int* clusters, double* lambdas, double* probabilities, double* glosh) {
+	tree.extract(clusters, lambdas, probabilities, glosh, p);
 }
 
-
-
-
-HDBSCAN::HDBSCAN(const arma::uword& N, const bool& verbose) :
+HDBSCAN::HDBSCAN(const arma::uword& N, Progress& p, Profiler& profiler) :
 	N{N},
-	p(Progress(6 * N, verbose)) {
+	p(p),
+	profiler(profiler),
+	tree(N) {
 		coreDistances = new double[N];
-		roots.reserve(N);
 	}
 
 void HDBSCAN::buildHierarchy(const vector<pair<double, arma::uword>>& mergeSequence,
-                             const unsigned int& minPts,
                              const arma::uword* minimum_spanning_tree) {
-	arma::uword cnt = 0;
-	std::vector<HDCluster*> points;
-	points.reserve(N);
-	std::generate_n(points.end(), N, [&cnt](){return new HDCluster(cnt++);});
-	roots.max_load_factor(3);
-	for (auto it = mergeSequence.begin(); it != mergeSequence.end();  ++it) if (p.increment()) {
+	// The node at the top of each set in the union-find, indexed by the root of the set.
+	std::vector<arma::uword> tops(N);
+	std::iota(tops.begin(), tops.end(), 0);
+	UnionFind<arma::uword> components(N);
+	ProgressMeter meter(p);
+	for (auto it = mergeSequence.begin(); it != mergeSequence.end() && meter.increment();  ++it) {
 		const arma::uword& n = it -> second;
-		if (minimum_spanning_tree[n] == NA_INTEGER) continue;
+		if (minimum_spanning_tree[n] == (arma::uword) NA_INTEGER) continue;
 #ifdef DEBUG
-		if (it->first == 0) throw Rcpp::exception("Zero distance");
-		if (it->first == NA_INTEGER) throw Rcpp::exception("NA distance");
-		if (it->first == INFINITY) throw Rcpp::exception("infinite distance");
+		if (it->first == 0) throw LargeVisError("Zero distance");
+		if (it->first == NA_INTEGER) throw LargeVisError("NA distance");
+		if (it->first == INFINITY) throw LargeVisError("infinite distance");
 #endif
-		HDCluster  *a, *b;
-		a = points[n]->getRoot();
-		b = points[minimum_spanning_tree[n]]->getRoot();
-		HDCluster* newparent = new HDCluster(a, b, cnt++, it->first);
-		roots.erase(a->id);
-		roots.erase(b->id);
-		roots.emplace(newparent->id, newparent);
-		points[n] = points[minimum_spanning_tree[n]] = newparent;
-		if (newparent->rank % 4096 == 0) condense(minPts, points);
-	}
-	roots.rehash(roots.size());
+		const arma::uword a = components.find(n);
+		const arma::uword b = components.find(minimum_spanning_tree[n]);
+		tops[components.unite(a, b)] = tree.merge(tops[a], tops[b], it->first);
 	}
+	meter.finish();
+	vector<arma::uword> roots;
+	for (arma::uword n = 0; n != N; ++n) if (components.find(n) == n) roots.push_back(tops[n]);
+	tree.setRoots(roots);
+	profiler.count("merges", N - roots.size());
+	profiler.count("roots", roots.size());
+}
 
 HDBSCAN::~HDBSCAN() {
 	delete[] coreDistances;
 }
 
-void HDBSCAN::makeCoreDistances(const sp_mat& edges,
-                                const IntegerMatrix& neighbors,
-                                const int& K) {
-	if (neighbors.nrow() < K) throw Rcpp::exception("Specified K bigger than the number of neighbors in the adjacency matrix.");
-	const IntegerVector kthNeighbors = neighbors.row(K - 1);
+void HDBSCAN::checkInputs(const NeighborGraph& graph, const unsigned int& K, const std::string& mstMethod) {
+	if (mstMethod.compare(string("Boruvka")) != 0 && mstMethod.compare(string("Prim")) != 0 &&
+      mstMethod.compare(string("ParallelPrim")) != 0) {
+		throw LargeVisError("Unknown minimum spanning tree method.");
+	}
+	if (K < 1) throw LargeVisError("K must be at least 1.");
+	if (graph.neighborsPerVertex() < K) throw LargeVisError("Specified K bigger than the number of neighbors in the adjacency matrix.");
+	for (vertexidxtype n = 0; n < graph.size(); n++) {
+		if (graph.countNeighbors(n) < K) throw LargeVisError("Insufficient neighbors.");
+	}
+}
+
+void HDBSCAN::makeCoreDistances(const NeighborGraph& graph, const unsigned int& K) {
 	for (arma::uword n = 0; n < N; n++) if (p.increment()) {
-		const arma::sword q = kthNeighbors[n];
-		if (q == -1 || q == NA_INTEGER) throw Rcpp::exception("Insufficient neighbors.");
-		coreDistances[n] = edges(n, q);
-		if (coreDistances[n] == 0) coreDistances[n] = max(edges(q, n), 1e-5);
+		coreDistances[n] = graph.neighbor(n, K - 1).distance;
+		if (coreDistances[n] == 0) coreDistances[n] = 1e-5;
 	}
 }
 
-IntegerVector HDBSCAN::build( const unsigned int& K,
-                              const sp_mat& edges,
-                              const unsigned int& minPts,
-                              const IntegerMatrix& neighbors) {
-	makeCoreDistances(edges, neighbors, K); // 1 N
-	PrimsAlgorithm<arma::uword, double> prim = PrimsAlgorithm<arma::uword, double>(N, coreDistances);
-	const arma::uword* minimum_spanning_tree = prim.run(edges, neighbors, p, 0); // 1N
-	vector< pair<double, arma::uword> > mergeSequence = prim.getMergeSequence();
-	buildHierarchy(mergeSequence, minPts, minimum_spanning_tree); // 1 N
-	vector<arma::uword> treevector(minimum_spanning_tree, minimum_spanning_tree + N);
-	return IntegerVector(treevector.begin(), treevector.end());
+vector< arma::uword > HDBSCAN::build(const unsigned int& K,
+                                     const NeighborGraph& graph,
+                                     const std::string& mstMethod) {
+	profiler.count("points", N);
+	profiler.phase("core distances");
+	makeCoreDistances(graph, K); // 1 N
+	profiler.phase("spanning tree");
+	vector<arma::uword> treevector;
+	vector< pair<double, arma::uword> > mergeSequence;
+	if (mstMethod.compare(string("Boruvka")) == 0) {
+		BoruvkaAlgorithm<arma::uword, double> boruvka = BoruvkaAlgorithm<arma::uword, double>(N, coreDistances);
+		const arma::uword* minimum_spanning_tree = boruvka.run(graph, p); // 1N
+		treevector.assign(minimum_spanning_tree, minimum_spanning_tree + N);
+		mergeSequence = boruvka.getMergeSequence();
+	} else if (mstMethod.compare(string("ParallelPrim")) == 0) {
+		ComponentPrimsAlgorithm<arma::uword, double> prim = ComponentPrimsAlgorithm<arma::uword, double>(N, coreDistances);
+		const arma::uword* minimum_spanning_tree = prim.run(graph, p); // 1N
+		treevector.assign(minimum_spanning_tree, minimum_spanning_tree + N);
+		mergeSequence = prim.getMergeSequence();
+	} else {
+		PrimsAlgorithm<arma::uword, double> prim = PrimsAlgorithm<arma::uword, double>(N, coreDistances);
+		const arma::uword* minimum_spanning_tree = prim.run(graph, p, 0); // 1N
+		treevector.assign(minimum_spanning_tree, minimum_spanning_tree + N);
+		mergeSequence = prim.getMergeSequence();
+	}
+	profiler.phase("hierarchy");
+	buildHierarchy(mergeSequence, treevector.data()); // 1 N
+	return treevector;
 }
 
-void HDBSCAN::condenseAndExtract(const unsigned int& minPts, int* clusters, double* lambdas) {
+void HDBSCAN::condenseAndExtract(const unsigned int& minPts, int* clusters, double* lambdas,
+                                 double* probabilities, double* glosh) {
+	profiler.phase("condense");
 	condense(minPts); // 1 N
+	profiler.phase("stability");
 	determineStability(minPts); // 1 N
-	extractClusters(clusters, lambdas); // 1 N
+	profiler.phase("extract");
+	extractClusters(clusters, lambdas, probabilities, glosh); // 1 N
 };
 
-Rcpp::List HDBSCAN::getHierarchy() const {
-	vector<int> nodemembership(N);
-	vector<double> lambdas(N);
-	vector<int> clusterParent;
-	vector<bool> clusterSelected;
-	vector<double> clusterStability;
-	vector<double> lambdaBirth;
-	vector<double> lambdaDeath;
+arma::mat HDBSCAN::membershipVectors(const NeighborGraph& graph, const int* clusters) {
+	return tree.membershipVectors(graph, clusters, p);
+}
 
-	int clusterCnt = 0;
-	for (auto it = roots.begin(); it != roots.end(); ++it) {
-		HDCluster& thisone = *(it->second);
-		thisone.reportHierarchy(clusterCnt, nodemembership, lambdas, clusterParent, clusterSelected, clusterStability, lambdaBirth, lambdaDeath);
-		delete &thisone;
+/*
+ * The single-linkage tree does not depend on minPts, so each value only needs its own copy of
+ * the tree to condense. Copies are made one per thread at a time, and only the extracted clusters
+ * and the reported hierarchy are kept.
+ */
+vector< HDBSCANClustering > HDBSCAN::sweep(const vector< unsigned int >& minPts) {
+	const int M = minPts.size();
+	vector< HDBSCANClustering > sweeps(M, HDBSCANClustering(N));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int m = 0; m < M; ++m) {
+		HDBSCANClustering& clustering = sweeps[m];
+		ClusterTree condensed = tree;
+		condensed.condense(minPts[m], p);
+		condensed.determineStability(minPts[m], p);
+		condensed.extract(clustering.clusters.data(), clustering.lambdas.data(), clustering.probabilities.data(),
+                      clustering.glosh.data(), p);
+		report(condensed, clustering.hierarchy);
 	}
+	return sweeps;
+}
 
-	return  List::create(Named("nodemembership") = IntegerVector(nodemembership.begin(), nodemembership.end()),
-                      Named("lambda") = NumericVector(lambdas.begin(), lambdas.end()),
-                      Named("parent") = IntegerVector(clusterParent.begin(), clusterParent.end()),
-                      Named("stability") = NumericVector(clusterStability.begin(), clusterStability.end()),
-                      Named("selected") = LogicalVector(clusterSelected.begin(), clusterSelected.end()),
-                      Named("lambda_birth") = NumericVector(lambdaBirth.begin(), lambdaBirth.end()),
-                    	Named("lambda_death") = NumericVector(lambdaDeath.begin(), lambdaDeath.end()),
-                      Named("coredistances") = wrap(vector<double>(coreDistances, coreDistances + N)));
-}
\ No newline at end of file
+void HDBSCAN::report(const ClusterTree& condensed, HierarchyReport& hierarchy) const {
+	hierarchy.report(condensed);
+	hierarchy.coreDistances.assign(coreDistances, coreDistances + N);
+}
+
+HierarchyReport HDBSCAN::getHierarchy() const {
+	HierarchyReport hierarchy(N);
+	report(tree, hierarchy);
+	return hierarchy;
+}
+
+HDBSCANResult hdbscanGraph(const NeighborGraph& graph,
+                           const int& K,
+                           const int& minPts,
+                           const std::string& mstMethod,
+                           const bool& membership,
+                           const bool& verbose,
+                           Profiler& profiler) {
+	HDBSCAN::checkInputs(graph, K, mstMethod);
+	const vertexidxtype N = graph.size();
+	Progress p((membership ? 7 : 6) * N, verbose);
+	HDBSCAN object(N, p, profiler);
+	HDBSCANResult ret(N);
+	// 1 N
+	ret.tree = object.build(K, graph, mstMethod); // 4N
+	HDBSCANClustering& clustering = ret.clustering;
+	object.condenseAndExtract(minPts, clustering.clusters.data(), clustering.lambdas.data(),
+                            clustering.probabilities.data(), clustering.glosh.data()); // 3N
+	profiler.phase("hierarchy report");
+	clustering.hierarchy = object.getHierarchy();
+	profiler.count("clusters", clustering.hierarchy.clusterParent.size());
+	if (membership) {
+		profiler.phase("membership");
+		ret.membership = object.membershipVectors(graph, clustering.clusters.data()); // 1N
+	}
+	return ret;
+}
@@ -0,0 +1,145 @@
+#include "largeVis.h"
+#include <progress.hpp>
+#include <vector>
+#include <algorithm>
+
+using namespace Rcpp;
+using namespace std;
+
+/*
+ * Assigns new points to the clusters of an existing hdbscan clustering, without rebuilding the tree.
+ *
+ * Each new point is attached to the tree through its nearest reference neighbor by mutual
+ * reachability distance. Starting from the condensed cluster that neighbor fell out of, we climb
+ * to the cluster that existed at the new point's lambda, and the point takes the label of the
+ * nearest selected cluster at or above it.
+ *
+ * Clusters are numbered in the pre-order of the hierarchy, so every parent precedes its children.
+ * Roots are the only clusters with a lambda_birth of zero.
+ */
+class HDBSCANPredictor {
+private:
+	const IntegerVector nodeMembership;
+	const NumericVector lambdas;
+	const IntegerVector clusterParent;
+	const NumericVector lambdaBirth;
+	const NumericVector coreDistances;
+	const unsigned int K;
+
+	vector< int > labelOf; // Label of the nearest selected cluster at or above each cluster
+	vector< double > minLambda, maxLambda; // Per label, over the reference points
+
+public:
+	HDBSCANPredictor(const IntegerVector& nodeMembership,
+                   const NumericVector& lambdas,
+                   const IntegerVector& clusterParent,
+                   const LogicalVector& selected,
+                   const NumericVector& lambdaBirth,
+                   const NumericVector& coreDistances,
+                   const unsigned int& K) :
+		nodeMembership{nodeMembership}, lambdas{lambdas}, clusterParent{clusterParent},
+		lambdaBirth{lambdaBirth}, coreDistances{coreDistances}, K{K},
+		labelOf(vector< int >(clusterParent.size(), NA_INTEGER)) {
+		int labels = 0;
+		for (int c = 0; c != clusterParent.size(); ++c) {
+			if (selected[c]) labelOf[c] = ++labels;
+			else if (lambdaBirth[c] != 0) labelOf[c] = labelOf[clusterParent[c]];
+		}
+		minLambda.assign(labels + 1, INFINITY);
+		maxLambda.assign(labels + 1, 0);
+		for (int n = 0; n != nodeMembership.size(); ++n) {
+			const int label = labelOf[nodeMembership[n]];
+			if (label == NA_INTEGER) continue;
+			minLambda[label] = min(minLambda[label], (double) lambdas[n]);
+			maxLambda[label] = max(maxLambda[label], (double) lambdas[n]);
+		}
+	}
+
+	// Returns false if the point has fewer than K neighbors.
+	bool predict(const int* neighbors,
+               const double* distances,
+               const unsigned int& rows,
+               int& label,
+               double& probability,
+               double& lambda,
+               vector< double >& sorted) const {
+		sorted.clear();
+		for (unsigned int k = 0; k != rows && neighbors[k] != -1; ++k) sorted.push_back(distances[k]);
+		if (sorted.size() < K) return false;
+		nth_element(sorted.begin(), sorted.begin() + (K - 1), sorted.end());
+		const double coreDistance = sorted[K - 1];
+
+		int nearest = -1;
+		double nearestDistance = INFINITY;
+		for (unsigned int k = 0; k != sorted.size(); ++k) {
+			const double d = max(distances[k], max(coreDistance, (double) coreDistances[neighbors[k]]));
+			if (d < nearestDistance) {
+				nearest = neighbors[k];
+				nearestDistance = d;
+			}
+		}
+		lambda = 1 / max(nearestDistance, 1e-5);
+		int cluster = nodeMembership[nearest];
+		while (lambdaBirth[cluster] > lambda) cluster = clusterParent[cluster];
+		label = labelOf[cluster];
+		if (label == NA_INTEGER) probability = 0;
+		else if (maxLambda[label] > minLambda[label]) {
+			probability = (min(lambda, maxLambda[label]) - minLambda[label]) / (maxLambda[label] - minLambda[label]);
+			probability = max(probability, 0.0);
+		} else probability = 1;
+		return true;
+	}
+};
+
+// [[Rcpp::export]]
+List hdbscan_predictc(const IntegerVector& nodeMembership,
+                      const NumericVector& lambdas,
+                      const IntegerVector& clusterParent,
+                      const LogicalVector& selected,
+                      const NumericVector& lambdaBirth,
+                      const NumericVector& coreDistances,
+                      const IntegerMatrix& neighbors,
+                      const NumericMatrix& distances,
+                      const int& K,
+                      const Rcpp::Nullable<Rcpp::NumericVector> threads,
+                      const bool verbose) {
+#ifdef _OPENMP
+	checkCRAN(threads);
+#endif
+	if (neighbors.nrow() != distances.nrow() || neighbors.ncol() != distances.ncol()) {
+		throw Rcpp::exception("The neighbor and distance matrices must have the same dimensions.");
+	}
+	if (K < 1 || neighbors.nrow() < K) throw Rcpp::exception("Specified K bigger than the number of neighbors.");
+	const int N = nodeMembership.size();
+	for (const int* it = neighbors.begin(); it != neighbors.end(); ++it) if (*it != -1 && (*it < 0 || *it >= N)) {
+		throw Rcpp::exception("Neighbor indices must be -1 or refer to a clustered point.");
+	}
+	const HDBSCANPredictor predictor = HDBSCANPredictor(nodeMembership, lambdas, clusterParent,
+                                                      selected, lambdaBirth, coreDistances, K);
+	const int M = neighbors.ncol();
+	const unsigned int rows = neighbors.nrow();
+	const int* neighborPtr = neighbors.begin();
+	const double* distancePtr = distances.begin();
+	vector< int > labels(M);
+	vector< double > probabilities(M), newLambdas(M);
+	Progress p(M, verbose);
+	bool insufficient = false;
+#ifdef _OPENMP
+#pragma omp parallel reduction(||:insufficient)
+#endif
+	{
+		vector< double > sorted;
+		sorted.reserve(rows);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for (int m = 0; m < M; ++m) if (p.increment()) {
+			if (! predictor.predict(neighborPtr + ((size_t) m * rows), distancePtr + ((size_t) m * rows), rows,
+                              labels[m], probabilities[m], newLambdas[m], sorted)) insufficient = true;
+		}
+	}
+	if (insufficient) throw Rcpp::exception("Insufficient neighbors.");
+	return List::create(Named("clusters") = IntegerVector(labels.begin(), labels.end()),
+                      Named("probabilities") = NumericVector(probabilities.begin(), probabilities.end()),
+                      Named("lambdas") = NumericVector(newLambdas.begin(), newLambdas.end()));
+}
@@ -1,248 +1,389 @@
 #include "largeVis.h"
 #include "hdbscan.h"
-#include "primsalgorithm.h"
 //#define DEBUG
 
-void HDCluster::newparent(vector<HDCluster*>& points, HDCluster* newparent) {
-	for (auto it = fallenPoints.begin(); it != fallenPoints.end(); ++it) {
-		points[it->first] = newparent;
-	}
-	if (left != nullptr) {
-		left->newparent(points, newparent);
-		right->newparent(points, newparent);
-	}
+ClusterTree::ClusterTree(const arma::uword& N) : N{N}, NONE{2 * N} {
+	const arma::uword capacity = 2 * N;
+	left.reserve(capacity);
+	right.reserve(capacity);
+	parent.reserve(capacity);
+	sz.reserve(capacity);
+	fallenCount.reserve(capacity);
+	lambdaBirth.reserve(capacity);
+	lambdaDeath.reserve(capacity);
+	sumLambdaP.reserve(capacity);
+	left.assign(N, NONE);
+	right.assign(N, NONE);
+	parent.assign(N, NONE);
+	sz.assign(N, 1);
+	fallenCount.assign(N, 0);
+	lambdaBirth.assign(N, 0);
+	lambdaDeath.assign(N, INFINITY);
+	sumLambdaP.assign(N, 0);
 }
 
-
-void HDCluster::condense(const unsigned int minPts, unsigned int level) {
-	if (left != nullptr) {
-		const unsigned int newlevel = (level == 0) ? level : level - 1;
-#ifdef _OPENMP
-#pragma omp task
-#endif
-{
-	left->condense(minPts, newlevel);
-}
-right->condense(minPts, newlevel);
-#ifdef _OPENMP
-#pragma omp taskwait
+arma::uword ClusterTree::merge(const arma::uword& a, const arma::uword& b, const double& d) {
+	const arma::uword id = left.size();
+	const double lambda = 1 / d;
+#ifdef DEBUG
+	if (lambda == INFINITY) throw LargeVisError("death is infiinity.");
 #endif
-innerCondense(minPts);
+	parent[a] = parent[b] = id;
+	lambdaBirth[a] = lambdaBirth[b] = lambda;
+	if (sz[a] < sz[b]) {
+		left.push_back(a);
+		right.push_back(b);
+	} else {
+		left.push_back(b);
+		right.push_back(a);
 	}
+	parent.push_back(NONE);
+	sz.push_back(sz[a] + sz[b]);
+	fallenCount.push_back(0);
+	lambdaBirth.push_back(0);
+	lambdaDeath.push_back(lambda);
+	sumLambdaP.push_back(0);
+	return id;
 }
 
-void HDCluster::innerCondense(const unsigned int minPts) {
-	if (left->sz < minPts) {
-		condenseTooSmall();
-		swap(left, right); // right definitely null, left not null but could be big or small
-		if (left->sz < minPts) {
-			condenseTooSmall();
-			rank = 0;
-		} else {
-			condenseSingleton();
-			rank = (left == nullptr) ? 0 : max(left->rank, right->rank) + 1;
-		}
-	}
+void ClusterTree::setRoots(const vector< arma::uword >& newRoots) {
+	roots = newRoots;
 }
 
-void HDCluster::mergeUp() {
-	if (left->sz == 1) {
-		sum_lambda_p += left->lambda_birth;
-		fallenPoints.emplace_back(left->id, left->lambda_birth);
+void ClusterTree::absorb(const arma::uword& node, const arma::uword& child) {
+	if (sz[child] == 1) {
+		sumLambdaP[node] += lambdaBirth[child];
+		fallenCount[node]++;
 	}
-	else sum_lambda_p += left->sum_lambda_p;
-	fallenPoints.splice(fallenPoints.end(), left->fallenPoints);
+	else sumLambdaP[node] += sumLambdaP[child];
+	fallenCount[node] += fallenCount[child];
+	absorbed[child] = true;
+	parent[child] = node;
 }
 
-// Entering function we know that child has a split of its own
-void HDCluster::condenseSingleton() {
-	mergeUp();
-	lambda_death = max(lambda_death, left->lambda_death);
-#ifdef DEBUG
-	if (lambda_death == INFINITY) throw Rcpp::exception("max infinity");
-#endif
-
-	right = left->right;
-	left->right = nullptr;
-	HDCluster* keep = left;
-	left = keep->left;
-	keep->left = nullptr;
-	delete keep;
+// Entering function we know that child has no split of its own
+void ClusterTree::condenseTooSmall(const arma::uword& node) {
+	absorb(node, left[node]);
+	left[node] = NONE;
 }
 
-// Entering function we know that child has no split of its own
-void HDCluster::condenseTooSmall() {
-	mergeUp();
+// Entering function we know that child has a split of its own
+void ClusterTree::condenseSingleton(const arma::uword& node) {
+	const arma::uword keep = left[node];
+	absorb(node, keep);
+	lambdaDeath[node] = max(lambdaDeath[node], lambdaDeath[keep]);
 #ifdef DEBUG
-	if (lambda_death == INFINITY) throw Rcpp::exception("Infinity is too small.");
+	if (lambdaDeath[node] == INFINITY) throw LargeVisError("max infinity");
 #endif
-
-	left->left = nullptr;
-	left->right = nullptr;
-
-	delete left;
-	left = nullptr;
+	left[node] = left[keep];
+	right[node] = right[keep];
+	if (left[node] != NONE) parent[left[node]] = parent[right[node]] = node;
 }
 
+void ClusterTree::innerCondense(const arma::uword& node, const unsigned int& minPts) {
+	if (sz[left[node]] < minPts) {
+		condenseTooSmall(node);
+		swap(left[node], right[node]); // right definitely NONE, left could be big or small
+		if (sz[left[node]] < minPts) condenseTooSmall(node);
+		else condenseSingleton(node);
+	}
+}
 
+/*
+ * Children have lower indices than their parents, so walking the merges in order condenses
+ * each cluster after its children, as a post-order traversal would.
+ */
+void ClusterTree::condense(const unsigned int& minPts, Progress& p) {
+	const arma::uword nodes = left.size();
+	absorbed.assign(nodes, false);
+	for (arma::uword node = N; node < nodes; ++node) innerCondense(node, minPts);
+	p.increment(N);
+}
 
+vector< arma::uword > ClusterTree::fallenFrom() const {
+	vector< arma::uword > owner(left.size());
+	for (arma::uword node = left.size(); node-- != 0;) {
+		if (! absorbed[node]) owner[node] = node;
+		else owner[node] = owner[parent[node]];
+	}
+	for (arma::uword n = 0; n != N; ++n) if (! absorbed[n]) owner[n] = NONE;
+	owner.resize(N);
+	return owner;
+}
 
-double HDCluster::determineStability(const unsigned int& minPts, Progress& p) {
-#ifdef DEBUG
-	if (sz < minPts && parent != nullptr) throw Rcpp::exception("Condense failed.");
-#endif
-	stability = sum_lambda_p - (lambda_birth * fallenPoints.size());
-	if (left == nullptr) { // leaf node
-		if (sz >= minPts) selected = true; // Otherwise, this is a parent singleton smaller than minPts.
-		p.increment();
-	} else {
-		const double childStabilities = left->determineStability(minPts, p) +
-			right->determineStability(minPts, p);
-		stability += lambda_death * (left->sz + right->sz);
-
-		if (stability > childStabilities) {
-			selected = true;
-			left->deselect();
-			right->deselect();
-		} else stability = childStabilities;
+template<class Count>
+vector< arma::uword > ClusterTree::subtreeCounts(Count count) const {
+	vector< arma::uword > counts(left.size(), 0);
+	for (arma::uword node = 0; node != left.size(); ++node) if (! absorbed[node]) {
+		counts[node] = count(node) ? 1 : 0;
+		if (left[node] != NONE) counts[node] += counts[left[node]] + counts[right[node]];
 	}
-	return stability;
+	return counts;
+}
+
+// Has one more entry than there are roots, the last being the total.
+vector< arma::uword > ClusterTree::rootOffsets(const vector< arma::uword >& counts) const {
+	vector< arma::uword > offsets(roots.size() + 1, 0);
+	for (arma::uword r = 0; r != roots.size(); ++r) offsets[r + 1] = offsets[r] + counts[roots[r]];
+	return offsets;
 }
 
-// Prevents agglomeration in a single cluster.
-void HDCluster::determineSubStability(const unsigned int& minPts, Progress& p) {
+void ClusterTree::determineStability(const unsigned int& minPts, Progress& p) {
+	const arma::uword nodes = left.size();
+	// With a single root, the root is never selected. Prevents agglomeration in a single cluster.
+	const arma::uword subRoot = (roots.size() == 1) ? roots.front() : NONE;
+	stability.assign(nodes, 0);
+	selected.assign(nodes, false);
+	for (arma::uword node = 0; node != nodes; ++node) if (! absorbed[node]) {
 #ifdef DEBUG
-	if (sz < minPts && parent != nullptr) throw Rcpp::exception("Condense failed.");
+		if (sz[node] < minPts && parent[node] != NONE) throw LargeVisError("Condense failed.");
 #endif
-	stability = sum_lambda_p - (lambda_birth * fallenPoints.size());
-	if (left != nullptr) {
-			const double childStabilities = left->determineStability(minPts, p) +
-																			right->determineStability(minPts, p);
-			if (childStabilities > stability) stability = childStabilities;
-	} else {
-		p.increment(sz);
+		stability[node] = sumLambdaP[node] - (lambdaBirth[node] * fallenCount[node]);
+		if (left[node] == NONE) { // leaf node
+			// Otherwise, this is a parent singleton smaller than minPts.
+			if (sz[node] >= minPts && node != subRoot) selected[node] = true;
+		} else {
+			const double childStabilities = stability[left[node]] + stability[right[node]];
+			if (node == subRoot) {
+				if (childStabilities > stability[node]) stability[node] = childStabilities;
+				continue;
+			}
+			stability[node] += lambdaDeath[node] * (sz[left[node]] + sz[right[node]]);
+			if (stability[node] > childStabilities) selected[node] = true;
+			else stability[node] = childStabilities;
+		}
+	}
+	// A selected cluster deselects everything beneath it.
+	vector< bool > covered(nodes, false);
+	for (arma::uword node = nodes; node-- != 0;) if (! absorbed[node] && parent[node] != NONE) {
+		const arma::uword up = parent[node];
+		if (selected[up] || covered[up]) {
+			covered[node] = true;
+			selected[node] = false;
+		}
 	}
+	p.increment(N);
 }
 
-
-void HDCluster::extract(
+void ClusterTree::extract(
 		int* clusters,
-		double* lambdas, // An N * 2 array where for each point n * 2 is the cluster id for the point and n * 2 + 1 is lambda_p.
-		int& selectedClusterCnt,
+		double* lambdas,
+		double* probabilities,
+		double* glosh,
 		Progress& p
-) const { // tracker of the clusterx
-	extract(clusters, lambdas, selectedClusterCnt, NA_INTEGER, p);
-}
-
-void HDCluster::extract( int* clusters,
-                         double* lambdas,
-                         int& selectedClusterCnt,
-                         int currentSelectedCluster,
-                         Progress& p) const {
-	if (selected) currentSelectedCluster = selectedClusterCnt++;
-	std::for_each(fallenPoints.begin(), fallenPoints.end(),
-               [&clusters, &lambdas, &currentSelectedCluster](const std::pair<arma::uword, double>& it) {
-               	clusters[it.first] = (currentSelectedCluster == 0) ? NA_INTEGER : currentSelectedCluster;
-               	lambdas[it.first] = it.second;
-               });
-	if (left != nullptr) {
-		left->extract(clusters, lambdas, selectedClusterCnt, currentSelectedCluster, p);
-		right->extract(clusters, lambdas, selectedClusterCnt, currentSelectedCluster, p);
-	} else {
-		p.increment(sz);
+) const {
+	// Selected clusters are numbered from 1 in pre-order, so each root's numbering can start at its offset.
+	const vector< arma::uword > offsets = rootOffsets(subtreeCounts([this](const arma::uword& node) {
+		return selected[node];
+	}));
+	const int selectedClusterCnt = offsets.back() + 1;
+	vector< int > assigned(left.size(), NA_INTEGER);
+	const int R = roots.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for (int r = 0; r < R; ++r) {
+		vector< arma::uword > stack(1, roots[r]);
+		int next = offsets[r] + 1;
+		while (! stack.empty()) {
+			const arma::uword node = stack.back();
+			stack.pop_back();
+			if (parent[node] != NONE) assigned[node] = assigned[parent[node]];
+			if (selected[node]) assigned[node] = next++;
+			if (left[node] != NONE) {
+				stack.push_back(right[node]);
+				stack.push_back(left[node]);
+			}
+		}
+	}
+	const vector< arma::uword > owner = fallenFrom();
+	for (arma::uword n = 0; n != N; ++n) if (owner[n] != NONE) {
+		const int cluster = assigned[owner[n]];
+		clusters[n] = (cluster == 0) ? NA_INTEGER : cluster;
+		lambdas[n] = lambdaBirth[n];
 	}
-}
-
-
-
-
-void HDCluster::reportHierarchy(
-		int& clusterCnt,
-		vector<int>& nodeMembership, // The clusterid of the immediate parent for each point
-		vector<double>& lambdas,
-		vector<int>& clusterParent,
-		vector<bool>& clusterSelected,
-		vector<double>& clusterStability,
-		vector<double>& lambdaBirth,
-		vector<double>& lambdaDeath) {
-	reportHierarchy(clusterCnt, nodeMembership, lambdas, clusterParent, clusterSelected, clusterStability,
-                 lambdaBirth, lambdaDeath, NA_REAL);
 
+	/*
+	 * Probabilities standardize lambda_p against the range of lambda_p in the point's cluster; outliers
+	 * keep their lambda_p. GLOSH compares lambda_p to the largest lambda_p among the points that fell
+	 * out of the same condensed cluster. Points that never fell are reported as members of the first
+	 * cluster in the hierarchy, with a lambda_p of 0, and are scored with them.
+	 */
+	vector< double > minLambda(selectedClusterCnt, INFINITY), maxLambda(selectedClusterCnt, -INFINITY);
+	vector< double > maxFallen(left.size(), 0);
+	for (arma::uword n = 0; n != N; ++n) {
+		const arma::uword node = (owner[n] == NONE) ? roots.front() : owner[n];
+		maxFallen[node] = max(maxFallen[node], lambdas[n]);
+		if (clusters[n] == NA_INTEGER) continue;
+		minLambda[clusters[n]] = min(minLambda[clusters[n]], lambdas[n]);
+		maxLambda[clusters[n]] = max(maxLambda[clusters[n]], lambdas[n]);
+	}
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (arma::uword n = 0; n < N; ++n) {
+		const double maxP = maxFallen[(owner[n] == NONE) ? roots.front() : owner[n]];
+		glosh[n] = (maxP - lambdas[n]) / maxP;
+		if (clusters[n] == NA_INTEGER) probabilities[n] = lambdas[n];
+		else probabilities[n] = (lambdas[n] - minLambda[clusters[n]]) / (maxLambda[clusters[n]] - minLambda[clusters[n]]);
+	}
+	p.increment(N);
 }
 
-void HDCluster::reportHierarchy(
-		int& clusterCnt,
+void ClusterTree::reportHierarchy(
 		vector<int>& nodeMembership, // The clusterid of the immediate parent for each point
 		vector<double>& lambdas,
 		vector<int>& clusterParent,
-		vector<bool>& clusterSelected,
+		vector<int>& clusterSelected,
 		vector<double>& clusterStability,
 		vector<double>& lambdaBirth,
-		vector<double>& lambdaDeath,
-		const int parentCluster) const {
-	int thisCluster = clusterCnt++;
-	std::for_each(fallenPoints.begin(), fallenPoints.end(),
-               [&nodeMembership, &lambdas, &thisCluster](const std::pair<arma::uword, double>& it) {
-               	nodeMembership[it.first] = thisCluster;
-               	lambdas[it.first] = it.second;
-               });
-	clusterParent.emplace_back(parentCluster);
-	clusterSelected.push_back(selected);
-	clusterStability.emplace_back(stability);
-	lambdaBirth.emplace_back(lambda_birth);
-	lambdaDeath.emplace_back(lambda_death);
-	if (left != nullptr) left->reportHierarchy(clusterCnt, nodeMembership, lambdas,
-     clusterParent, clusterSelected, clusterStability, lambdaBirth, lambdaDeath, thisCluster);
-	if (right != nullptr) right->reportHierarchy(clusterCnt, nodeMembership, lambdas,
-     clusterParent, clusterSelected, clusterStability, lambdaBirth, lambdaDeath,  thisCluster);
-}
-
-
-
-
-
-
-
-HDCluster::~HDCluster() {
-	if (left != nullptr) delete left;
-	if (right != nullptr) delete right;
-}
-
-HDCluster::HDCluster(const arma::uword& id) : sz(1), id(id) { }
-
-HDCluster::HDCluster(HDCluster* a, HDCluster* b, const arma::uword& id, const double& d) :
-	lambda_birth(0), lambda_death(1/d), sz(a->sz + b->sz), id(id), rank(max(a->rank, b->rank) + 1) {
-#ifdef DEBUG
-	if (lambda_death == INFINITY) throw Rcpp::exception("death is infiinity.");
+		vector<double>& lambdaDeath) const {
+	// Clusters are numbered in pre-order, each root's subtree taking the range starting at its offset.
+	const vector< arma::uword > offsets = rootOffsets(subtreeCounts([](const arma::uword&) { return true; }));
+	const arma::uword M = offsets.back();
+	clusterParent.assign(M, NA_INTEGER);
+	clusterSelected.assign(M, 0);
+	clusterStability.assign(M, 0);
+	lambdaBirth.assign(M, 0);
+	lambdaDeath.assign(M, 0);
+	vector< int > clusterOf(left.size(), NA_INTEGER);
+	const int R = roots.size();
+	// Roots have no parent, and report NA, which the dendrogram code relies on.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
 #endif
-	a->parent = b->parent = this;
-	a->lambda_birth = b->lambda_birth = lambda_death;
-
-	if (a->sz < b->sz) {
-		left = a;
-		right = b;
-	} else {
-		right = a;
-		left = b;
+	for (int r = 0; r < R; ++r) {
+		vector< arma::uword > stack(1, roots[r]);
+		int next = offsets[r];
+		while (! stack.empty()) {
+			const arma::uword node = stack.back();
+			stack.pop_back();
+			const int id = clusterOf[node] = next++;
+			if (parent[node] != NONE) clusterParent[id] = clusterOf[parent[node]];
+			clusterSelected[id] = selected[node];
+			clusterStability[id] = stability[node];
+			lambdaBirth[id] = this->lambdaBirth[node];
+			lambdaDeath[id] = this->lambdaDeath[node];
+			if (left[node] != NONE) {
+				stack.push_back(right[node]);
+				stack.push_back(left[node]);
+			}
+		}
+	}
+	const vector< arma::uword > owner = fallenFrom();
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (arma::uword n = 0; n < N; ++n) if (owner[n] != NONE) {
+		nodeMembership[n] = clusterOf[owner[n]];
+		lambdas[n] = this->lambdaBirth[n];
 	}
 }
 
+/*
+ * Soft clustering. Each point's membership in each selected cluster combines:
+ *  - a distance-based score, the inverse of the distance to the point's nearest neighbor in the cluster; and
+ *  - an outlier-based score, from the lambda at which the point and the cluster join in the tree,
+ *    relative to the largest lambda_p in the cluster.
+ * The product is normalized and scaled by the probability that the point is in any cluster.
+ */
+arma::mat ClusterTree::membershipVectors(const NeighborGraph& graph, const int* clusters, Progress& p) const {
+	const arma::uword nodes = left.size();
+	// Pre-order of the condensed tree. A node's subtree is the range [position, position + subtreeSize).
+	const vector< arma::uword > subtreeSize = subtreeCounts([](const arma::uword&) { return true; });
+	vector< arma::uword > order, position(nodes, NONE), rootOf(nodes), selectedNodes;
+	vector< arma::uword > stack;
+	for (auto it = roots.begin(); it != roots.end(); ++it) {
+		stack.push_back(*it);
+		while (! stack.empty()) {
+			const arma::uword node = stack.back();
+			stack.pop_back();
+			position[node] = order.size();
+			order.push_back(node);
+			rootOf[node] = *it;
+			if (selected[node]) selectedNodes.push_back(node);
+			if (left[node] != NONE) {
+				stack.push_back(right[node]);
+				stack.push_back(left[node]);
+			}
+		}
+	}
+	const arma::uword M = order.size();
+	const arma::uword C = selectedNodes.size();
+	auto contains = [&position, &subtreeSize](const arma::uword& ancestor, const arma::uword& node) {
+		return position[node] >= position[ancestor] && position[node] < position[ancestor] + subtreeSize[ancestor];
+	};
+
+	/*
+	 * The lambda at which each condensed cluster joins each selected cluster, or -1 if one contains
+	 * the other, in which case the points that fell out of the cluster join at their own lambda_p.
+	 */
+	vector< double > heights(M * C);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (arma::uword c = 0; c < C; ++c) {
+		const arma::uword target = selectedNodes[c];
+		double* column = heights.data() + (c * M);
+		for (arma::uword i = 0; i != M; ++i) {
+			const arma::uword node = order[i];
+			if (rootOf[node] != rootOf[target]) column[i] = 0;
+			else if (contains(node, target) || contains(target, node)) column[i] = -1;
+			else if (contains(parent[node], target)) column[i] = lambdaBirth[node];
+			else column[i] = column[position[parent[node]]];
+		}
+	}
 
+	vector< double > maxLambda(C, 0);
+	for (arma::uword n = 0; n != N; ++n) if (clusters[n] != NA_INTEGER && clusters[n] > 0) {
+		maxLambda[clusters[n] - 1] = max(maxLambda[clusters[n] - 1], lambdaBirth[n]);
+	}
 
-
-
-HDCluster* HDCluster::getRoot() {
-	if (parent == nullptr) return this;
-	return parent->getRoot();
-}
-
-void HDCluster::deselect() {
-	if (selected) selected = false;
-	else if (left != nullptr) {
-		left->deselect();
-		right->deselect();
+	const vector< arma::uword > owner = fallenFrom();
+	arma::mat membership(N, C, arma::fill::zeros);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		vector< double > distanceScore(C), outlierScore(C);
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for (arma::uword n = 0; n < N; ++n) if (p.increment() && owner[n] != NONE && C != 0) {
+			const double lambda = lambdaBirth[n];
+			const double* column = heights.data() + position[owner[n]];
+
+			std::fill(distanceScore.begin(), distanceScore.end(), INFINITY);
+			for (auto it = graph.beginNeighbors(n); it != graph.endNeighbors(n); ++it) {
+				const int cluster = clusters[it->neighbor];
+				if (cluster == NA_INTEGER || cluster <= 0) continue;
+				distanceScore[cluster - 1] = min(distanceScore[cluster - 1], it->distance);
+			}
+			double distanceSum = 0, outlierSum = 0, bestHeight = -1;
+			arma::uword best = 0;
+			for (arma::uword c = 0; c != C; ++c) {
+				distanceScore[c] = (distanceScore[c] == INFINITY) ? 0 : 1 / max(distanceScore[c], 1e-5);
+				distanceSum += distanceScore[c];
+				const double height = (column[c * M] < 0) ? lambda : column[c * M];
+				outlierScore[c] = maxLambda[c] / (max(maxLambda[c] - height, 0.0) + 1e-8);
+				outlierSum += outlierScore[c];
+				if (height > bestHeight) {
+					bestHeight = height;
+					best = c;
+				}
+			}
+			// The probability that the point is in any cluster.
+			const double inCluster = (maxLambda[best] == 0) ? 0 : min(bestHeight, maxLambda[best]) / maxLambda[best];
+			double combinedSum = 0;
+			for (arma::uword c = 0; c != C; ++c) {
+				const double d = (distanceSum == 0) ? 1 : distanceScore[c] / distanceSum;
+				combinedSum += d * outlierScore[c] / outlierSum;
+			}
+			for (arma::uword c = 0; c != C; ++c) {
+				const double d = (distanceSum == 0) ? 1 : distanceScore[c] / distanceSum;
+				membership(n, c) = inCluster * (d * outlierScore[c] / outlierSum) / combinedSum;
+			}
+		}
 	}
+	return membership;
 }
-
-
-
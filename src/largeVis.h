@@ -9,8 +9,40 @@
 #endif
 #endif
 
+/*
+ * The engines build either inside the R package, on RcppArmadillo, or with LARGEVIS_STANDALONE
+ * defined, on Armadillo alone, as the library and command-line driver built by CMakeLists.txt.
+ * Code shared by both builds throws LargeVisError, warns with largeVisWarning and marks missing
+ * values with NA_INTEGER and NA_REAL, which the standalone build defines as R does.
+ */
+#ifdef LARGEVIS_STANDALONE
+#include <armadillo>
+#include <climits>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#define NA_INTEGER INT_MIN
+#define NA_REAL (std::numeric_limits< double >::quiet_NaN())
+#define ISNA(x) (std::isnan(x))
+
+typedef std::runtime_error LargeVisError;
+
+inline void largeVisWarning(const std::string& message) {
+	std::cerr << "Warning: " << message << std::endl;
+}
+#else
 #include <RcppArmadillo.h>
 
+typedef Rcpp::exception LargeVisError;
+
+inline void largeVisWarning(const std::string& message) {
+	Rcpp::warning(message);
+}
+#endif
+
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -29,7 +61,7 @@ typedef uword iterationtype;
 typedef unsigned int dimidxtype;
 typedef unsigned int kidxtype;
 
-#ifdef _OPENMP
+#if defined(_OPENMP) && ! defined(LARGEVIS_STANDALONE)
 void checkCRAN(Rcpp::Nullable<Rcpp::NumericVector> threads);
 #endif
 
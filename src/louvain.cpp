@@ -0,0 +1,318 @@
+#include "largeVis.h"
+#include "unionfind.h"
+#include <progress.hpp>
+#include <vector>
+#include <algorithm>
+
+using namespace Rcpp;
+using namespace std;
+using namespace arma;
+
+/*
+ * Modularity clustering of a symmetric weighted graph, such as wij, in the manner of Louvain with the
+ * connectivity refinement of Leiden.
+ *
+ * Each level moves vertices between communities to increase modularity, splits every community into
+ * its connected parts, and then collapses the communities into the vertices of the next level's
+ * graph. The moves are made in parallel and in rounds: the vertices are divided into a few classes
+ * by a hash of their index, and in each round the vertices of one class choose their best community
+ * against the state left by the previous round. The result therefore does not depend on the number
+ * of threads. A sweep through every class that does not increase modularity is undone, and ends the
+ * level.
+ *
+ * The graph is kept in compressed sparse column form. Since it is symmetric, the column of a vertex
+ * lists its neighbors, and an internal weight is carried on the diagonal. The degrees and gains are
+ * only right for a symmetric graph, so an asymmetric wij is rejected.
+ */
+class Louvain {
+protected:
+	vertexidxtype n;
+	vector< edgeidxtype > offsets;
+	vector< vertexidxtype > targets;
+	vector< double > weights;
+	vector< double > degree; // Including any weight on the diagonal
+	double total = 0; // Twice the total edge weight
+	const double resolution;
+	const unsigned int classes = 4;
+	const unsigned int maxSweeps = 32;
+	Progress& progress;
+
+	typedef pair< vertexidxtype, double > Link;
+
+	inline unsigned int classOf(const vertexidxtype& v) const {
+		return (unsigned int) (((unsigned long long) v * 0x9E3779B97F4A7C15ULL) >> 60) % classes;
+	}
+
+	void computeDegrees() {
+		degree.assign(n, 0);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (vertexidxtype v = 0; v < n; ++v) {
+			for (edgeidxtype e = offsets[v]; e != offsets[v + 1]; ++e) degree[v] += weights[e];
+		}
+		// Summed in order, so that no decision depends on the number of threads.
+		total = 0;
+		for (vertexidxtype v = 0; v != n; ++v) total += degree[v];
+	}
+
+	// Sums the weights from v to each community, into links sorted by community.
+	void linksOf(const vertexidxtype& v, const vector< vertexidxtype >& community, vector< Link >& links) const {
+		links.clear();
+		for (edgeidxtype e = offsets[v]; e != offsets[v + 1]; ++e) {
+			if (targets[e] != v) links.emplace_back(community[targets[e]], weights[e]);
+		}
+		sort(links.begin(), links.end(),
+       [](const Link& a, const Link& b) { return a.first < b.first; });
+		vector< Link >::size_type out = 0;
+		for (vector< Link >::size_type i = 0; i != links.size(); ++i) {
+			if (out != 0 && links[out - 1].first == links[i].first) links[out - 1].second += links[i].second;
+			else links[out++] = links[i];
+		}
+		links.resize(out);
+	}
+
+	/*
+	 * The community that gains most from holding v, relative to the others it could join; v stays
+	 * unless another is strictly better, and ties go to the smaller community id.
+	 */
+	vertexidxtype bestCommunity(const vertexidxtype& v,
+                              const vector< vertexidxtype >& community,
+                              const vector< double >& communityDegree,
+                              vector< Link >& links) const {
+		linksOf(v, community, links);
+		const vertexidxtype own = community[v];
+		const double scale = resolution * degree[v] / total;
+		double stay = - scale * (communityDegree[own] - degree[v]);
+		for (auto it = links.begin(); it != links.end(); ++it) if (it->first == own) stay += it->second;
+		vertexidxtype best = own;
+		double bestGain = stay;
+		for (auto it = links.begin(); it != links.end(); ++it) if (it->first != own) {
+			const double gain = it->second - scale * communityDegree[it->first];
+			if (gain > bestGain) {
+				best = it->first;
+				bestGain = gain;
+			}
+		}
+		return best;
+	}
+
+	double modularity(const vector< vertexidxtype >& community) const {
+		vector< double > communityDegree(n, 0), internalOf(n, 0);
+		for (vertexidxtype v = 0; v != n; ++v) communityDegree[community[v]] += degree[v];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (vertexidxtype v = 0; v < n; ++v) {
+			for (edgeidxtype e = offsets[v]; e != offsets[v + 1]; ++e) {
+				if (community[targets[e]] == community[v]) internalOf[v] += weights[e];
+			}
+		}
+		double internal = 0, expected = 0;
+		for (vertexidxtype v = 0; v != n; ++v) internal += internalOf[v];
+		for (vertexidxtype c = 0; c != n; ++c) expected += (communityDegree[c] / total) * (communityDegree[c] / total);
+		return internal / total - resolution * expected;
+	}
+
+	// Local moving. Returns the modularity reached.
+	double moveVertices(vector< vertexidxtype >& community) {
+		vector< double > communityDegree(degree);
+		vector< vertexidxtype > proposal(n), previous;
+		double current = modularity(community);
+		for (unsigned int sweep = 0; sweep != maxSweeps && ! progress.check_abort(); ++sweep) {
+			previous = community;
+			bool moved = false;
+			for (unsigned int c = 0; c != classes; ++c) {
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+				{
+					vector< Link > links;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1024)
+#endif
+					for (vertexidxtype v = 0; v < n; ++v) {
+						proposal[v] = (classOf(v) == c) ? bestCommunity(v, community, communityDegree, links) : community[v];
+					}
+				}
+				for (vertexidxtype v = 0; v != n; ++v) if (proposal[v] != community[v]) {
+					communityDegree[community[v]] -= degree[v];
+					communityDegree[proposal[v]] += degree[v];
+					community[v] = proposal[v];
+					moved = true;
+				}
+			}
+			if (! moved) break;
+			const double next = modularity(community);
+			if (next <= current) {
+				community = previous;
+				break;
+			}
+			current = next;
+		}
+		return current;
+	}
+
+	/*
+	 * Splits each community into its connected parts, and numbers them from 0 in order of their
+	 * smallest vertex. Returns the number of communities.
+	 */
+	vertexidxtype refine(vector< vertexidxtype >& community) const {
+		ConcurrentUnionFind< vertexidxtype > parts(n);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1024)
+#endif
+		for (vertexidxtype v = 0; v < n; ++v) {
+			for (edgeidxtype e = offsets[v]; e != offsets[v + 1]; ++e) {
+				if (targets[e] > v && community[targets[e]] == community[v]) parts.unite(v, targets[e]);
+			}
+		}
+		vector< vertexidxtype > number(n, -1);
+		vertexidxtype C = 0;
+		for (vertexidxtype v = 0; v != n; ++v) {
+			const vertexidxtype root = parts.find(v);
+			if (number[root] == -1) number[root] = C++;
+			community[v] = number[root];
+		}
+		return C;
+	}
+
+	// Replaces the graph with that of its C communities.
+	void aggregate(const vector< vertexidxtype >& community, const vertexidxtype& C) {
+		vector< vertexidxtype > memberStart(C + 1, 0), members(n);
+		for (vertexidxtype v = 0; v != n; ++v) memberStart[community[v] + 1]++;
+		for (vertexidxtype c = 0; c != C; ++c) memberStart[c + 1] += memberStart[c];
+		vector< vertexidxtype > fill(memberStart.begin(), memberStart.end() - 1);
+		for (vertexidxtype v = 0; v != n; ++v) members[fill[community[v]]++] = v;
+
+		vector< vector< Link > > rows(C);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+		for (vertexidxtype c = 0; c < C; ++c) {
+			vector< Link >& row = rows[c];
+			for (vertexidxtype m = memberStart[c]; m != memberStart[c + 1]; ++m) {
+				const vertexidxtype v = members[m];
+				for (edgeidxtype e = offsets[v]; e != offsets[v + 1]; ++e) row.emplace_back(community[targets[e]], weights[e]);
+			}
+			sort(row.begin(), row.end(),
+        [](const Link& a, const Link& b) { return a.first < b.first; });
+			vector< Link >::size_type out = 0;
+			for (vector< Link >::size_type i = 0; i != row.size(); ++i) {
+				if (out != 0 && row[out - 1].first == row[i].first) row[out - 1].second += row[i].second;
+				else row[out++] = row[i];
+			}
+			row.resize(out);
+		}
+		n = C;
+		offsets.assign(n + 1, 0);
+		for (vertexidxtype c = 0; c != n; ++c) offsets[c + 1] = offsets[c] + rows[c].size();
+		targets.resize(offsets[n]);
+		weights.resize(offsets[n]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (vertexidxtype c = 0; c < n; ++c) {
+			edgeidxtype e = offsets[c];
+			for (auto it = rows[c].begin(); it != rows[c].end(); ++it, ++e) {
+				targets[e] = it->first;
+				weights[e] = it->second;
+			}
+		}
+		computeDegrees();
+	}
+
+	// Whether each edge is matched by one in the other direction, of the same weight to within rounding.
+	bool isSymmetric() const {
+		bool symmetric = true;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(&&:symmetric)
+#endif
+		for (vertexidxtype v = 0; v < n; ++v) {
+			for (edgeidxtype e = offsets[v]; e != offsets[v + 1]; ++e) {
+				const vertexidxtype w = targets[e];
+				if (w == v) continue;
+				const auto first = targets.begin() + offsets[w], last = targets.begin() + offsets[w + 1];
+				const auto it = lower_bound(first, last, v);
+				if (it == last || *it != v ||
+            fabs(weights[it - targets.begin()] - weights[e]) > 1e-8 * max(weights[it - targets.begin()], weights[e])) {
+					symmetric = false;
+				}
+			}
+		}
+		return symmetric;
+	}
+
+public:
+	Louvain(const arma::sp_mat& wij,
+          const double& resolution,
+          Progress& progress) : n(wij.n_cols),
+                                offsets(wij.col_ptrs, wij.col_ptrs + wij.n_cols + 1),
+                                targets(wij.row_indices, wij.row_indices + wij.n_nonzero),
+                                weights(wij.values, wij.values + wij.n_nonzero),
+                                resolution{resolution},
+                                progress(progress) {
+		if (wij.n_rows != wij.n_cols) throw Rcpp::exception("The wij matrix must be square.");
+		if (resolution <= 0) throw Rcpp::exception("resolution must be positive.");
+		for (auto it = weights.begin(); it != weights.end(); ++it) {
+			if (*it < 0) throw Rcpp::exception("Weights must not be negative.");
+		}
+		if (! isSymmetric()) throw Rcpp::exception("The wij matrix must be symmetric.");
+		computeDegrees();
+		if (total <= 0) throw Rcpp::exception("The graph has no edges.");
+	}
+
+	/*
+	 * Runs up to maxLevels levels, stopping early when a level merges nothing. The labels of the
+	 * original vertices after each level are written as a column of levels, and the modularity
+	 * reached by each level to modularities.
+	 */
+	void run(const unsigned int& maxLevels,
+           vector< vector< vertexidxtype > >& levels,
+           vector< double >& modularities) {
+		const vertexidxtype N = n;
+		vector< vertexidxtype > labels(N);
+		for (vertexidxtype v = 0; v != N; ++v) labels[v] = v;
+		for (unsigned int level = 0; level != maxLevels; ++level) {
+			if (level != 0 && progress.check_abort()) break;
+			vector< vertexidxtype > community(n);
+			for (vertexidxtype v = 0; v != n; ++v) community[v] = v;
+			moveVertices(community);
+			const vertexidxtype C = refine(community);
+			if (C == n && level != 0) break;
+			for (vertexidxtype v = 0; v != N; ++v) labels[v] = community[labels[v]];
+			modularities.push_back(modularity(community));
+			levels.push_back(labels);
+			progress.increment(N);
+			if (C == n) break;
+			aggregate(community, C);
+		}
+	}
+};
+
+// [[Rcpp::export]]
+List louvain_cpp(const arma::sp_mat& wij,
+                 const double& resolution,
+                 const int& maxLevels,
+                 Rcpp::Nullable<Rcpp::NumericVector> threads,
+                 const bool& verbose) {
+#ifdef _OPENMP
+	checkCRAN(threads);
+#endif
+	if (maxLevels < 1) throw Rcpp::exception("max_levels must be at least 1.");
+	Progress p(wij.n_cols * maxLevels, verbose);
+	Louvain louvain(wij, resolution, p);
+	vector< vector< vertexidxtype > > levels;
+	vector< double > modularities;
+	louvain.run(maxLevels, levels, modularities);
+	const vertexidxtype N = wij.n_cols;
+	IntegerMatrix hierarchy(N, levels.size());
+	for (vector< double >::size_type l = 0; l != levels.size(); ++l) {
+		for (vertexidxtype v = 0; v != N; ++v) hierarchy(v, l) = levels[l][v] + 1;
+	}
+	IntegerVector clusters(N);
+	for (vertexidxtype v = 0; v != N; ++v) clusters[v] = levels.back()[v] + 1;
+	return List::create(Named("clusters") = clusters,
+                      Named("hierarchy") = hierarchy,
+                      Named("modularity") = NumericVector(modularities.begin(), modularities.end()));
+}
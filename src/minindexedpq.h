@@ -1,5 +1,8 @@
+#ifndef _LARGEVISMININDEXEDPQ
+#define _LARGEVISMININDEXEDPQ
 #include <vector>
 #include <memory>
+#include <algorithm>
 #include <math.h>
 
 template<class V, class D>
@@ -21,6 +24,7 @@ private:
 	NodePointer root = NULL;
 	const V MaxSize;
 	std::vector< PairNode > PointerArray;
+	std::vector< NodePointer > treeArray = std::vector< NodePointer >(5); // Scratch space for combineSiblings
 
 	void compareAndLink(NodePointer &first, NodePointer second) {
 		if (second == NULL) return;
@@ -45,7 +49,6 @@ private:
 		if (firstSibling->nextSibling == NULL) {
 			return firstSibling;
 		}
-		static std::vector< NodePointer > treeArray(5);
 		unsigned int numSiblings = 0;
 		for (; firstSibling != NULL; numSiblings++) {
 			if (numSiblings == treeArray.size()) treeArray.resize(numSiblings * 2);
@@ -58,7 +61,7 @@ private:
 		unsigned int i = 0;
 		for (; i + 1 < numSiblings; i += 2) compareAndLink(treeArray[i], treeArray[i + 1]);
 		int j = i - 2;
-		if (j == numSiblings - 3) compareAndLink (treeArray[j], treeArray[j + 2]);
+		if (j == (int) numSiblings - 3) compareAndLink (treeArray[j], treeArray[j + 2]);
 		for (; j >= 2; j -= 2) compareAndLink(treeArray[j - 2], treeArray[j] );
 		return treeArray[0];
 	}
@@ -82,11 +85,11 @@ public:
 		return sz;
 	}
 
-	const bool isEmpty() const {
+	bool isEmpty() const {
 		return root == NULL;
 	}
 
-	const bool contains(const V& i) const {
+	bool contains(const V& i) const {
 		return PointerArray[i].present;
 	}
 
@@ -130,3 +133,124 @@ public:
   	return root -> distance;
   }
 };
+
+/*
+ * Indexed d-ary min-heap with the same interface as PairingHeap.
+ *
+ * The heap is a flat array of indices, with each key stored by index, so a decrease-key moves
+ * the index up through at most log_d(N) parents without chasing pointers between nodes. Keys
+ * remain available from keyOf after their index has been popped.
+ *
+ * Equal keys are popped in decreasing order of index, so the order does not depend on the order
+ * of insertion. OPTICS relies on this to visit tied seeds deterministically.
+ */
+template<class V, class D, unsigned int Arity = 4>
+class DaryHeap {
+private:
+	const V MaxSize;
+	const V NONE;
+	std::vector< V > heap;
+	std::vector< V > position; // Position of each index in heap, or NONE if not present
+	std::vector< D > keys;
+
+	inline bool before(const V& a, const V& b) const {
+		return keys[a] < keys[b] || (keys[a] == keys[b] && a > b);
+	}
+
+	void place(const V& pos, const V& i) {
+		heap[pos] = i;
+		position[i] = pos;
+	}
+
+	void siftUp(V pos) {
+		const V i = heap[pos];
+		while (pos != 0) {
+			const V up = (pos - 1) / Arity;
+			if (! before(i, heap[up])) break;
+			place(pos, heap[up]);
+			pos = up;
+		}
+		place(pos, i);
+	}
+
+	void siftDown(V pos) {
+		const V i = heap[pos];
+		const V sz = heap.size();
+		while (true) {
+			const V first = pos * Arity + 1;
+			if (first >= sz) break;
+			const V last = std::min(first + Arity, sz);
+			V best = first;
+			for (V c = first + 1; c < last; ++c) if (before(heap[c], heap[best])) best = c;
+			if (! before(heap[best], i)) break;
+			place(pos, heap[best]);
+			pos = best;
+		}
+		place(pos, i);
+	}
+
+public:
+	explicit DaryHeap(const V& N) : MaxSize{N}, NONE{N},
+		position(std::vector< V >(N, N)), keys(std::vector< D >(N, INFINITY)) {
+		heap.reserve(N);
+	}
+
+	const V pop() {
+		const V ret = heap.front();
+		position[ret] = NONE;
+		const V back = heap.back();
+		heap.pop_back();
+		if (! heap.empty()) {
+			place(0, back);
+			siftDown(0);
+		}
+		return ret;
+	}
+
+	const V size() const {
+		return heap.size();
+	}
+
+	bool isEmpty() const {
+		return heap.empty();
+	}
+
+	bool contains(const V& i) const {
+		return position[i] != NONE;
+	}
+
+	void insert(const V &n, const D &x) {
+		keys[n] = x;
+		heap.push_back(n);
+		position[n] = heap.size() - 1;
+		siftUp(heap.size() - 1);
+	}
+
+	// All keys but start's are equal, so start followed by the rest in decreasing order is already a heap.
+	void batchInsert(const V& n, const V& start) {
+		heap.assign(1, start);
+		position[start] = 0;
+		for (V i = n; i-- != 0;) if (i != start) {
+			heap.push_back(i);
+			position[i] = heap.size() - 1;
+		}
+		for (V i = 0; i != n; i++) keys[i] = (start == i) ? -1 : INFINITY;
+	}
+
+	bool decreaseIf(const V& i, const D &newDistance) {
+		if (keys[i] < newDistance) return false;
+		keys[i] = newDistance;
+		if (contains(i)) siftUp(position[i]);
+		return true;
+	}
+
+	D keyOf(const V& i) const {
+		return keys[i];
+	}
+
+	D topKey() const {
+		if (heap.empty()) return INFINITY;
+		return keys[heap.front()];
+	}
+};
+#endif
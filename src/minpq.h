@@ -1,5 +1,4 @@
 #include "largeVis.h"
-using namespace Rcpp;
 
 class MinIndexedPQ {
 private:
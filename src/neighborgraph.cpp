@@ -0,0 +1,154 @@
+#include "neighborgraph.h"
+
+/*
+ * Walks the vertex's nearest neighbors (sorted by vertex index) together with column v of the
+ * edge matrix, which holds the vertices that have v as a neighbor. Returns the number of entries
+ * in the vertex's row; if out is not null, the entries are also written there.
+ */
+template<class T>
+edgeidxtype NeighborGraph::merge(const sp_mat& edges,
+                                 const T* neighbors,
+                                 const vertexidxtype& v,
+                                 vector< pair<vertexidxtype, kidxtype> >& sorted,
+                                 Edge* out,
+                                 edgeidxtype& forwardCount) const {
+	sorted.clear();
+	const T* const vNeighbors = neighbors + (v * K);
+	for (kidxtype k = 0; k != K && vNeighbors[k] != -1; ++k) sorted.emplace_back(vNeighbors[k], k);
+	forwardCount = sorted.size();
+	if (out == nullptr) sort(sorted.begin(), sorted.end());
+	else {
+		for (auto it = sorted.begin(); it != sorted.end(); ++it) out[it->second] = {it->first, edges(v, it->first)};
+		sort(sorted.begin(), sorted.end());
+	}
+
+	edgeidxtype r = forwardCount;
+	auto forward = sorted.begin();
+	for (auto it = edges.begin_col(v); it != edges.end_col(v); ++it) {
+		const vertexidxtype w = it.row();
+		while (forward != sorted.end() && forward->first < w) ++forward;
+		if (forward != sorted.end() && forward->first == w) {
+			if (out != nullptr) out[forward->second].distance = max(out[forward->second].distance, (distancetype) *it);
+			++forward;
+		} else if (w != v) {
+			if (out != nullptr) out[r] = {w, *it};
+			++r;
+		}
+	}
+	return r;
+}
+
+template<class T>
+void NeighborGraph::build(const sp_mat& edges, const T* neighbors) {
+	if ((vertexidxtype) edges.n_cols != N || (vertexidxtype) edges.n_rows != N) {
+		throw LargeVisError("The edge and neighbor matrices have different numbers of vertices.");
+	}
+	for (const T* it = neighbors; it != neighbors + N * K; ++it) {
+		if (*it != -1 && (*it < 0 || *it >= N)) throw LargeVisError("Neighbor indices must be -1 or refer to a vertex.");
+	}
+	offsets[0] = 0;
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		vector< pair<vertexidxtype, kidxtype> > sorted;
+		sorted.reserve(K);
+		edgeidxtype forwardCount;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for (vertexidxtype v = 0; v < N; ++v) {
+			offsets[v + 1] = merge(edges, neighbors, v, sorted, nullptr, forwardCount);
+		}
+	}
+	for (vertexidxtype v = 0; v != N; ++v) offsets[v + 1] += offsets[v];
+	adjacency.resize(offsets[N]);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		vector< pair<vertexidxtype, kidxtype> > sorted;
+		sorted.reserve(K);
+		edgeidxtype forwardCount;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for (vertexidxtype v = 0; v < N; ++v) {
+			merge(edges, neighbors, v, sorted, adjacency.data() + offsets[v], forwardCount);
+			reverseStart[v] = offsets[v] + forwardCount;
+		}
+	}
+}
+
+NeighborGraph::NeighborGraph(const sp_mat& edges, const imat& neighbors) :
+	N(neighbors.n_cols), K(neighbors.n_rows), maxDistance(INFINITY),
+	offsets(vector< edgeidxtype >(N + 1)), reverseStart(vector< edgeidxtype >(N)) {
+	build(edges, neighbors.memptr());
+}
+
+#ifndef LARGEVIS_STANDALONE
+NeighborGraph::NeighborGraph(const sp_mat& edges, const Rcpp::IntegerMatrix& neighbors) :
+	N(neighbors.ncol()), K(neighbors.nrow()), maxDistance(INFINITY),
+	offsets(vector< edgeidxtype >(N + 1)), reverseStart(vector< edgeidxtype >(N)) {
+	build(edges, neighbors.begin());
+}
+#endif
+
+NeighborGraph::NeighborGraph(const vector< vector< Edge > >& rows, const kidxtype& K, const distancetype& radius) :
+	N(rows.size()), K(K), maxDistance(radius),
+	offsets(vector< edgeidxtype >(N + 1)), reverseStart(vector< edgeidxtype >(N)) {
+	// For each vertex, the vertices that have it as a neighbor, in index order.
+	vector< edgeidxtype > reverseOffsets(N + 1, 0);
+	vector< vertexidxtype > reverse;
+	if (radius == INFINITY) {
+		for (vertexidxtype v = 0; v != N; ++v) {
+			for (auto it = rows[v].begin(); it != rows[v].end(); ++it) reverseOffsets[it->neighbor + 1]++;
+		}
+		for (vertexidxtype v = 0; v != N; ++v) reverseOffsets[v + 1] += reverseOffsets[v];
+		reverse.resize(reverseOffsets[N]);
+		vector< edgeidxtype > fill(reverseOffsets.begin(), reverseOffsets.end() - 1);
+		for (vertexidxtype v = 0; v != N; ++v) {
+			for (auto it = rows[v].begin(); it != rows[v].end(); ++it) reverse[fill[it->neighbor]++] = v;
+		}
+	}
+	vector< edgeidxtype > reverseCount(N, 0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		vector< vertexidxtype > own;
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for (vertexidxtype v = 0; v < N; ++v) if (! reverse.empty()) {
+			own.clear();
+			for (auto it = rows[v].begin(); it != rows[v].end(); ++it) own.push_back(it->neighbor);
+			sort(own.begin(), own.end());
+			for (edgeidxtype r = reverseOffsets[v]; r != reverseOffsets[v + 1]; ++r) {
+				if (binary_search(own.begin(), own.end(), reverse[r])) reverse[r] = -1;
+				else reverseCount[v]++;
+			}
+		}
+	}
+	offsets[0] = 0;
+	for (vertexidxtype v = 0; v != N; ++v) offsets[v + 1] = offsets[v] + rows[v].size() + reverseCount[v];
+	adjacency.resize(offsets[N]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (vertexidxtype v = 0; v < N; ++v) {
+		Edge* out = adjacency.data() + offsets[v];
+		for (auto it = rows[v].begin(); it != rows[v].end(); ++it) *out++ = *it;
+		reverseStart[v] = offsets[v] + rows[v].size();
+		if (reverse.empty()) continue;
+		for (edgeidxtype r = reverseOffsets[v]; r != reverseOffsets[v + 1]; ++r) if (reverse[r] != -1) {
+			const vertexidxtype w = reverse[r];
+			// Distances are symmetric, so the reverse entry takes the distance from w's own row.
+			for (auto it = rows[w].begin(); it != rows[w].end(); ++it) if (it->neighbor == v) {
+				*out++ = *it;
+				out[-1].neighbor = w;
+				break;
+			}
+		}
+	}
+}
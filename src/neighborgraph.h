@@ -0,0 +1,109 @@
+#ifndef _LARGEVISNEIGHBORGRAPH
+#define _LARGEVISNEIGHBORGRAPH
+#include "largeVis.h"
+#include <vector>
+
+using namespace std;
+using namespace arma;
+
+/*
+ * Symmetrized nearest-neighbor graph, in compressed sparse row form, used by the clustering
+ * algorithms in place of lookups into the edge matrix.
+ *
+ * The row for each vertex holds the vertex's own nearest neighbors, in the order of the neighbor
+ * matrix, followed by the vertices that have it as a nearest neighbor but are not among its own
+ * ("reverse" neighbors), in index order. The distance stored for a pair is the larger of the
+ * two directed entries in the edge matrix, so a pair missing from one direction takes its
+ * distance from the other.
+ *
+ * Rows are therefore sorted by distance only in their leading segment, and only as far as the
+ * neighbor matrix is. The reverse segment is kept in index order so that DBSCAN can test whether
+ * a pair is in it by binary search. A scan for the neighbors within a distance may stop at the
+ * first forward neighbor beyond it, but must read the whole reverse segment.
+ *
+ * A graph may also be built from exact neighbor lists, such as those found by a SpatialGrid. A
+ * graph built from range queries holds every pair within its radius and nothing else, so its rows
+ * are mutual and have no reverse segments.
+ */
+class NeighborGraph {
+public:
+	struct Edge {
+		vertexidxtype neighbor;
+		distancetype distance;
+	};
+	typedef const Edge* const_iterator;
+
+private:
+	const vertexidxtype N;
+	const kidxtype K;
+	const distancetype maxDistance;
+	vector< edgeidxtype > offsets; // N + 1 entries
+	vector< edgeidxtype > reverseStart; // Start of the reverse segment for each vertex
+	vector< Edge > adjacency;
+
+	template<class T>
+	void build(const sp_mat& edges, const T* neighbors);
+	template<class T>
+	edgeidxtype merge(const sp_mat& edges,
+                    const T* neighbors,
+                    const vertexidxtype& v,
+                    vector< pair<vertexidxtype, kidxtype> >& sorted,
+                    Edge* out,
+                    edgeidxtype& forwardCount) const;
+
+public:
+	NeighborGraph(const sp_mat& edges, const imat& neighbors);
+#ifndef LARGEVIS_STANDALONE
+	NeighborGraph(const sp_mat& edges, const Rcpp::IntegerMatrix& neighbors);
+#endif
+	/*
+	 * From each vertex's own neighbors, sorted by distance. K must be at least the length of every
+	 * row. If radius is finite, the rows must hold exactly the pairs within it; otherwise the reverse
+	 * neighbors are found from the rows.
+	 */
+	NeighborGraph(const vector< vector< Edge > >& rows, const kidxtype& K, const distancetype& radius = INFINITY);
+
+	vertexidxtype size() const {
+		return N;
+	}
+	// The number of rows in the neighbor matrix the graph was built from.
+	kidxtype neighborsPerVertex() const {
+		return K;
+	}
+	edgeidxtype n_edges() const {
+		return adjacency.size();
+	}
+	// The distance within which the graph holds every pair, or infinity for nearest-neighbor graphs.
+	distancetype radius() const {
+		return maxDistance;
+	}
+
+	const_iterator begin(const vertexidxtype& v) const {
+		return adjacency.data() + offsets[v];
+	}
+	const_iterator end(const vertexidxtype& v) const {
+		return adjacency.data() + offsets[v + 1];
+	}
+	const_iterator beginNeighbors(const vertexidxtype& v) const {
+		return begin(v);
+	}
+	const_iterator endNeighbors(const vertexidxtype& v) const {
+		return adjacency.data() + reverseStart[v];
+	}
+	const_iterator beginReverse(const vertexidxtype& v) const {
+		return endNeighbors(v);
+	}
+	const_iterator endReverse(const vertexidxtype& v) const {
+		return end(v);
+	}
+
+	// The number of the vertex's own nearest neighbors; less than K if the neighbor matrix was padded.
+	kidxtype countNeighbors(const vertexidxtype& v) const {
+		return reverseStart[v] - offsets[v];
+	}
+	// The k'th (0-indexed) nearest neighbor of v; k must be less than countNeighbors(v).
+	const Edge& neighbor(const vertexidxtype& v, const kidxtype& k) const {
+		return adjacency[offsets[v] + k];
+	}
+};
+#endif
@@ -115,15 +115,15 @@ void AnnoySearch<M, V>::recurse(const Neighborholder& indices, list< Neighborhol
 };
 
 template<class M, class V>
-void AnnoySearch<M, V>::setSeed(Rcpp::Nullable< NumericVector >& seed) {
+void AnnoySearch<M, V>::setSeed(const long* seed) {
 	long innerSeed;
-	if (seed.isNotNull()) {
+	if (seed != nullptr) {
 #ifdef _OPENMP
 		storedThreads = omp_get_max_threads();
 		omp_set_num_threads(1);
 		omp_set_dynamic(0);
 #endif
-		innerSeed = NumericVector(seed)[0];
+		innerSeed = *seed;
 	} else {
 		random_device hardseed;
 		innerSeed = hardseed();
@@ -140,8 +140,13 @@ void AnnoySearch<M, V>::trees(const unsigned int& n_trees, const unsigned int& n
 #pragma omp parallel for
 #endif
 	for (unsigned int t = 0; t < n_trees; t++) if (! p.check_abort()) {
+		Profiler::Busy busy(profiler);
 		list< Neighborholder > local;
-		recurse(indices, local);
+		{
+			Profiler::Span span(profiler, "tree");
+			recurse(indices, local);
+		}
+		Profiler::Span span(profiler, "merge leaves");
 		mergeNeighbors(local);
 	}
 #ifdef _OPENMP
@@ -169,7 +174,7 @@ void AnnoySearch<M, V>::reduceOne(const vertexidxtype& i,
 	 */
 	auto continueWriting = std::transform(newNeighborhood.begin(), newNeighborhood.end(), knns.begin_col(i),
                                         [](const std::pair<distancetype, vertexidxtype>& input) {return input.second;});
-	if (continueWriting == knns.begin_col(i)) throw Rcpp::exception("At reduction, no neighbors for vertex.");
+	if (continueWriting == knns.begin_col(i)) throw LargeVisError("At reduction, no neighbors for vertex.");
 	sort(knns.begin_col(i), continueWriting);
 	std::fill(continueWriting, knns.end_col(i), -1);
 
@@ -177,13 +182,19 @@ void AnnoySearch<M, V>::reduceOne(const vertexidxtype& i,
 }
 
 template<class M, class V>
-void AnnoySearch<M, V>::reduceThread(const vertexidxtype& loopstart,
-                                     				const vertexidxtype& end) {
+edgeidxtype AnnoySearch<M, V>::reduceThread(const vertexidxtype& loopstart,
+                                            const vertexidxtype& end,
+                                            ProgressMeter& meter) {
+	Profiler::Busy busy(profiler);
+	Profiler::Span span(profiler, "reduce chunk");
 	vector< std::pair<distancetype, vertexidxtype> > newNeighborhood;
 	newNeighborhood.reserve(K * threshold);
-	for (vertexidxtype i = loopstart; i != end; ++i) if (p.increment()) {
+	edgeidxtype candidates = 0;
+	for (vertexidxtype i = loopstart; i != end && meter.increment(); ++i) {
+		candidates += treeNeighborhoods[i].size();
 		reduceOne(i, newNeighborhood);
 	}
+	return candidates;
 }
 
 	/*
@@ -194,6 +205,8 @@ void AnnoySearch<M, V>::reduceThread(const vertexidxtype& loopstart,
 template<class M, class V>
 void AnnoySearch<M, V>::reduce() {
 	knns = imat(K,N);
+	ThreadCounter candidates;
+	ProgressMeter meter(p);
 #ifdef _OPENMP
 	const unsigned int dynamo = omp_get_dynamic();
 	omp_set_dynamic(0);
@@ -203,17 +216,23 @@ void AnnoySearch<M, V>::reduce() {
 	const vertexidxtype chunk = N;
 #endif
 	for (vertexidxtype i = 0; i <= N; i += chunk) {
-		reduceThread(i, min(i + chunk, N));
+		candidates.add(reduceThread(i, min(i + chunk, N), meter));
 	}
 #ifdef _OPENMP
 	omp_set_dynamic(dynamo);
 #endif
+	meter.finish();
+	profiler.count("tree_candidates", candidates);
+	profiler.count("distance_evaluations", candidates);
 }
 
 template<class M, class V>
-void AnnoySearch<M, V>::exploreThread(const imat& old_knns,
-				                                     const vertexidxtype& loopstart,
-				                                     const vertexidxtype& end) {
+edgeidxtype AnnoySearch<M, V>::exploreThread(const imat& old_knns,
+                                             const vertexidxtype& loopstart,
+                                             const vertexidxtype& end,
+                                             ProgressMeter& meter) {
+	Profiler::Busy busy(profiler);
+	Profiler::Span span(profiler, "explore chunk");
 	/*
 	 * The goal here is to maintain a size-K minHeap of the points with the shortest distances
 	 * to the target point. This is a merge sort with more than two sorted arrays being merged.
@@ -226,13 +245,15 @@ void AnnoySearch<M, V>::exploreThread(const imat& old_knns,
 	vector< Position > positionVector;
 	positionVector.reserve(K + 1);
 
-	for (vertexidxtype i = loopstart; i != end; ++i) if (p.increment()) {
-		exploreOne(i, old_knns, nodeHeap, positionHeap, positionVector);
+	edgeidxtype candidates = 0;
+	for (vertexidxtype i = loopstart; i != end && meter.increment(); ++i) {
+		candidates += exploreOne(i, old_knns, nodeHeap, positionHeap, positionVector);
 	}
+	return candidates;
 }
 
 template<class M, class V>
-void AnnoySearch<M,V>::exploreOne(const vertexidxtype& i,
+edgeidxtype AnnoySearch<M,V>::exploreOne(const vertexidxtype& i,
 												                 const imat& old_knns,
 												                 vector< std::pair<distancetype, vertexidxtype> >& nodeHeap,
 												                 MinIndexedPQ& positionHeap,
@@ -255,12 +276,14 @@ void AnnoySearch<M,V>::exploreOne(const vertexidxtype& i,
 	}
 
 	vertexidxtype lastOne = -1;
+	edgeidxtype candidates = 0;
 	while (! positionHeap.isEmpty()) {
 		const vertexidxtype nextOne = positionHeap.minKey();
 
 		if (nextOne != lastOne && nextOne != i) {
 			addHeap(nodeHeap, x_i, nextOne);
 			lastOne = nextOne;
+			candidates++;
 		}
 		advanceHeap(positionHeap, positionVector);
 	}
@@ -273,18 +296,21 @@ void AnnoySearch<M,V>::exploreOne(const vertexidxtype& i,
 	*/
 	auto copyContinuation = std::transform(nodeHeap.begin(), nodeHeap.end(), knns.begin_col(i),
                                         [](const std::pair<distancetype, vertexidxtype>& input) {return input.second;});
-	if (copyContinuation == knns.begin_col(i)) throw Rcpp::exception("No neighbors after exploration - this is a bug.");
+	if (copyContinuation == knns.begin_col(i)) throw LargeVisError("No neighbors after exploration - this is a bug.");
 	sort(knns.begin_col(i), copyContinuation);
 	std::fill(copyContinuation, knns.end_col(i), -1);
+	return candidates;
 }
 
 template<class M, class V>
 void AnnoySearch<M,V>::exploreNeighborhood(const unsigned int& maxIter) {
 	const kidxtype K = knns.n_rows;
 	imat old_knns = imat(K,N);
+	ThreadCounter candidates;
 
 	for (unsigned int T = 0; T != maxIter; ++T) if (! p.check_abort()) {
 		swap(knns, old_knns);
+		ProgressMeter meter(p);
 #ifdef _OPENMP
 		const unsigned int dynamo = omp_get_dynamic();
 		omp_set_dynamic(0);
@@ -294,12 +320,15 @@ void AnnoySearch<M,V>::exploreNeighborhood(const unsigned int& maxIter) {
 		const vertexidxtype chunk = N;
 #endif
 		for (vertexidxtype i = 0; i <= N; i += chunk) {
-			exploreThread(old_knns, i, min(i + chunk, N));
+			candidates.add(exploreThread(old_knns, i, min(i + chunk, N), meter));
 		}
 #ifdef _OPENMP
 		omp_set_dynamic(dynamo);
 #endif
+		meter.finish();
 	}
+	profiler.count("explore_candidates", candidates);
+	profiler.count("distance_evaluations", candidates);
 }
 
 /*
@@ -307,6 +336,8 @@ void AnnoySearch<M,V>::exploreNeighborhood(const unsigned int& maxIter) {
  */
 template<class M, class V>
 imat AnnoySearch<M, V>::sortAndReturn() {
+	ThreadCounter distances;
+	ProgressMeter meter(p);
 #ifdef _OPENMP
 	const unsigned int dynamo = omp_get_dynamic();
 	if (omp_get_num_threads() > 1) omp_set_dynamic(0);
@@ -316,22 +347,30 @@ imat AnnoySearch<M, V>::sortAndReturn() {
 	const vertexidxtype chunk = N;
 #endif
 	for (vertexidxtype i = 0; i <= N; i += chunk) {
-		sortCopyThread(i, min(i + chunk, N));
+		distances.add(sortCopyThread(i, min(i + chunk, N), meter));
 	}
 #ifdef _OPENMP
 	if (omp_get_num_threads() > 1) omp_set_dynamic(dynamo);
 #endif
+	meter.finish();
+	profiler.count("distance_evaluations", distances);
 	return knns;
 }
 
 template<class M, class V>
-void AnnoySearch<M,V>::sortCopyThread(const vertexidxtype& start,
-                                      const vertexidxtype& end) {
+edgeidxtype AnnoySearch<M,V>::sortCopyThread(const vertexidxtype& start,
+                                             const vertexidxtype& end,
+                                             ProgressMeter& meter) {
+	Profiler::Busy busy(profiler);
+	Profiler::Span span(profiler, "sort chunk");
 	vector< std::pair<distancetype, vertexidxtype>> holder;
 	holder.reserve(K);
-	for (vertexidxtype i = start; i != end; ++i) if (p.increment()) {
+	edgeidxtype distances = 0;
+	for (vertexidxtype i = start; i != end && meter.increment(); ++i) {
 		sortCopyOne(holder, i);
+		distances += holder.size();
 	}
+	return distances;
 }
 
 template<class M, class V>
@@ -5,8 +5,9 @@
 #include <memory>
 #include "progress.hpp"
 #include "minpq.h"
+#include "profiler.h"
+#include "progressmeter.h"
 
-using namespace Rcpp;
 using namespace std;
 using namespace arma;
 
@@ -44,17 +45,19 @@ private:
 	void recurse(const Neighborholder& indices, list< Neighborholder >& localNeighborhood);
 	void mergeNeighbors(const list< Neighborholder >& neighbors);
 
+	// Each thread function returns the number of distances it evaluated.
 	void reduceOne(const vertexidxtype& i, vector< std::pair<distancetype, vertexidxtype> >& newNeighborhood);
-	void reduceThread(const vertexidxtype& loopstart, const vertexidxtype& end);
+	edgeidxtype reduceThread(const vertexidxtype& loopstart, const vertexidxtype& end, ProgressMeter& meter);
 
-	void exploreThread(const imat& old_knns, const vertexidxtype& loopstart, const vertexidxtype& end);
-	void exploreOne(const vertexidxtype& i, const imat& old_knns,
+	edgeidxtype exploreThread(const imat& old_knns, const vertexidxtype& loopstart, const vertexidxtype& end,
+                           ProgressMeter& meter);
+	edgeidxtype exploreOne(const vertexidxtype& i, const imat& old_knns,
                   vector< std::pair<distancetype, vertexidxtype> >& nodeHeap,
                   MinIndexedPQ& positionHeap, vector< Position >& positionVector);
 	void advanceHeap(MinIndexedPQ& positionHeap, vector< Position>& positionVector) const;
 
 	void sortCopyOne(vector< std::pair<distancetype, vertexidxtype>>& holder, const vertexidxtype& i);
-	void sortCopyThread(const vertexidxtype& start, const vertexidxtype& end);
+	edgeidxtype sortCopyThread(const vertexidxtype& start, const vertexidxtype& end, ProgressMeter& meter);
 
 	inline void addHeap(vector< std::pair<distancetype, vertexidxtype> >& heap, const V& x_i, const vertexidxtype& j) const;
 	inline void addToNeighborhood(const V& x_i, const vertexidxtype& j,
@@ -65,6 +68,7 @@ protected:
 	const kidxtype K;
 	const vertexidxtype N;
 	Progress& p;
+	Profiler& profiler;
 	unsigned int threshold = 0;
 	int threshold2 = 0;
 
@@ -76,18 +80,20 @@ protected:
 	}
 
 public:
-	AnnoySearch(const M& data, const kidxtype& K, Progress& p) : data{data}, K{K}, N(data.n_cols), p(p) {
+	AnnoySearch(const M& data, const kidxtype& K, Progress& p, Profiler& profiler = Profiler::none()) :
+		data{data}, K{K}, N(data.n_cols), p(p), profiler(profiler) {
 		treeNeighborhoods = new Neighborhood[N];
 		for (vertexidxtype i = 0; i != N; ++i) treeNeighborhoods[i] = Neighborhood();
 	}
 
-	AnnoySearch(const AnnoySearch& other) : AnnoySearch(other.data, other.K, other.p) {}
+	AnnoySearch(const AnnoySearch& other) : AnnoySearch(other.data, other.K, other.p, other.profiler) {}
 
 	virtual ~AnnoySearch() {
 		delete[] treeNeighborhoods;
 	}
 
-	void setSeed(Rcpp::Nullable< NumericVector >& seed);
+	// Searches on one thread from the given seed, so that the result can be reproduced, or from a random seed if it is null.
+	void setSeed(const long* seed);
 
 	void trees(const unsigned int& n_trees, const unsigned int& newThreshold);
 	void reduce();
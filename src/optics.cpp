@@ -1,8 +1,6 @@
-#include <RcppArmadillo.h>
-#include "minindexedpq.h"
-#include <queue>
-#include <Rmath.h>
-#include <progress.hpp>
+#include "largeVis.h"
+#include "optics.h"
+#include "spatialgrid.h"
 
 using namespace Rcpp;
 using namespace std;
@@ -10,153 +8,229 @@ using namespace arma;
 
 //#define DEBUG
 
-class OPTICS {
-protected:
-	const sp_mat* edges;
-	const imat* neighbors;
-	const double eps;
-	const long long N;
+// Runs OPTICS on the graph, in the form returned to R.
+static List opticsGraph(const NeighborGraph& graph,
+                        const double& eps,
+                        const int& minPts,
+                        const bool& useQueue,
+                        const bool& verbose,
+                        Profiler& profiler) {
+	const OPTICSOrdering ordering = opticsOrdering(graph, eps, minPts, useQueue, verbose, profiler);
+	List ret;
+	ret["order"] = IntegerVector(ordering.order.begin(), ordering.order.end()) +1;
+	ret["reachdist"] = NumericVector(ordering.reachdist.begin(), ordering.reachdist.end());
+	ret["coredist"] = NumericVector(ordering.coredist.begin(), ordering.coredist.end());
+	ret["predecessor"] = IntegerVector(ordering.predecessor.begin(), ordering.predecessor.end()) + 1;
+	ret["counters"] = NumericVector::create(Named("points") = graph.size(),
+                                          Named("heap_inserts") = ordering.heapInserts,
+                                          Named("heap_decreases") = ordering.heapDecreases,
+                                          Named("heap_pops") = ordering.heapPops,
+                                          Named("neighbor_lookups") = ordering.neighborLookups);
+	return ret;
+}
 
-	bool* visited;
-	vector< long long > orderedPoints;
-	vector< double > reachdist, coredist;
-	priority_queue< pair<double, long> > seedQueue;
-	vector< long long > predecessor;
-
-	Progress progress;
+// [[Rcpp::export]]
+SEXP optics_cpp(const arma::sp_mat& edges,
+                const arma::imat& neighbors,
+                const double& eps,
+                const int& minPts,
+                const bool& useQueue,
+                const bool& verbose) {
+	Profiler profiler;
+	profiler.phase("neighbor graph");
+	const NeighborGraph graph = NeighborGraph(edges, neighbors);
+	return profiler.attach(opticsGraph(graph, eps, minPts, useQueue, verbose, profiler));
+}
 
-	const long double reachabilityDistance(const long long& p,
-                                  			 const long long& q) const {
-		double dist = max((*edges)(p, q), (*edges)(q, p));
-		return max(coredist[p], dist);
-	}
+// OPTICS on points given by their coordinates in up to three dimensions, from a spatial grid.
+// [[Rcpp::export]]
+SEXP optics_coords(const arma::mat& coords,
+                   const double& eps,
+                   const int& minPts,
+                   const bool& useQueue,
+                   Rcpp::Nullable<Rcpp::NumericVector> threads,
+                   const bool& verbose) {
+#ifdef _OPENMP
+	checkCRAN(threads);
+#endif
+	Profiler profiler;
+	profiler.phase("neighbor graph");
+	const NeighborGraph graph = gridRangeGraph(coords, eps, minPts);
+	return profiler.attach(opticsGraph(graph, eps, minPts, useQueue, verbose, profiler));
+}
+
+/*
+ * Extracts clusterings from a finished OPTICS ordering, without revisiting the neighbor graph.
+ * Positions are indices into the ordering, and reach(i) is the reachability distance of the
+ * point at position i, taken as infinite past the end so that the last cluster is closed.
+ */
+class OPTICSExtractor {
+protected:
+	const long long N;
+	vector< long long > order;
+	vector< double > reach;
+	vector< double > core;
 
-	void getNeighbors(const long long& p,
-                    PairingHeap< long long, double >& seeds) {
-		bool exceeded = false;
-		const sp_colvec pEdges = edges->col(p);
-		for (auto it = neighbors -> begin_col(p);
-       	 (it != neighbors -> end_col(p)) && (*it != -1);
-       	 it++) if (! visited[*it]) {
-			long long q = *it;
-			if (pEdges[q] < eps) addNeighbor(p, q, seeds);
-			else {
-				exceeded = true;
-				break;
-			}
-		}
-		if (! exceeded) for (auto it = edges -> begin_col(p);
-                         it != edges -> end_col(p);
-                         it++) {
-			if (! visited[it.row()] && *it < eps) {
-				addNeighbor(p, it.row(), seeds);
-			}
-		}
+	inline double reachAt(const long long& i) const {
+		return (i < N) ? reach[i] : INFINITY;
 	}
-
-	void addNeighbor(const long long& p,
-                   const long long& q,
-                   PairingHeap< long long, double>& seeds) {
-		if (visited[q]) return;
-		const double newReachabilityDistance = reachabilityDistance(p, q);
-
-		if (! seeds.contains(q)) {
-			seeds.insert(q, newReachabilityDistance);
-			predecessor[q] = p;
-		} else if (seeds.decreaseIf(q, newReachabilityDistance))  predecessor[q] = p;
+	inline bool steepDown(const long long& i, const double& ixi) const {
+		return reachAt(i) * ixi >= reachAt(i + 1);
 	}
-
-public:
-	OPTICS(const sp_mat& edges,
-         const imat& neighbors,
-         const double& eps,
-         const unsigned int& minPts,
-         const bool& verbose) : edges{&edges}, neighbors{&neighbors},
-         								 eps{eps}, N(neighbors.n_cols),
-         								 visited(new bool[N]),
-								         orderedPoints(vector<long long>()),
-								         reachdist(vector< double >(N, INFINITY)),
-								         coredist(vector< double >(N)),
-								         predecessor(vector< long long >(N, NA_INTEGER)),
-								         progress(Progress(N, verbose)) {
-         	if (neighbors.n_rows < minPts) throw Rcpp::exception("Insufficient neighbors.");
-         	if (minPts < 2) throw Rcpp::exception("minPts must be >= 2");
-         	orderedPoints.reserve(N);
-         	for (long long n = 0; n != N; n++) {
-         		double nthDistance = edges(n, neighbors(minPts - 2, n));
-         		visited[n] = FALSE;
-         		coredist[n] = (nthDistance < eps) ? nthDistance : INFINITY;
-         	}
-        }
-
-	~OPTICS() {
-		delete[] visited;
+	inline bool steepUp(const long long& i, const double& ixi) const {
+		return reachAt(i) <= reachAt(i + 1) * ixi;
 	}
 
-	void queue() {
-		for (long long n = 0; n != N; n++) {
-			seedQueue.emplace(coredist[n], n);
+	struct SteepDownArea {
+		long long start, end;
+		double maximum, mib;
+	};
+
+	// Drops the areas that can no longer start a cluster, and raises the others' mib.
+	static void filterAreas(vector< SteepDownArea >& areas, const double& mib, const double& ixi) {
+		auto kept = areas.begin();
+		for (auto it = areas.begin(); it != areas.end(); ++it) if (it->maximum * ixi > mib) {
+			*kept = *it;
+			kept->mib = max(kept->mib, mib);
+			++kept;
 		}
+		areas.erase(kept, areas.end());
 	}
 
-	inline void runOne(const long long &p, PairingHeap<long long, double> &seeds) {
-		visited[p] = true;
-		orderedPoints.push_back(p);
-		if (coredist[p] == INFINITY) return; // core-dist is undefined
-		getNeighbors(p, seeds);
-		while (!seeds.isEmpty()) {
-			long long q = seeds.pop();
-			double key = seeds.keyOf(q);
-			if (key == seeds.topKey()) {
-				long long r = seeds.pop();
-				if (r > q) swap(q, r);
-				seeds.insert(r, key);
-			}
-			visited[q] = true;
-			orderedPoints.push_back(q);
-			reachdist[q] = key;
-			if (coredist[q] == INFINITY) continue;
-			getNeighbors(q, seeds);
+public:
+	OPTICSExtractor(const IntegerVector& order,
+                  const NumericVector& reachdist,
+                  const NumericVector& coredist) : N(order.size()),
+                  								 order(vector< long long >(N)),
+                  								 reach(vector< double >(N)),
+                  								 core(vector< double >(N)) {
+		for (long long i = 0; i != N; ++i) {
+			const long long p = order[i] - 1;
+			if (p < 0 || p >= reachdist.size() || p >= coredist.size()) throw Rcpp::exception("Invalid OPTICS ordering.");
+			this->order[i] = p;
+			reach[i] = reachdist[p];
+			core[i] = coredist[p];
 		}
 	}
 
-	void runAll() {
-		PairingHeap<long long, double> seeds(N);
-		for (long long p = 0; p != N && progress.increment(); p++) {
-			if (! visited[p]) runOne(p, seeds);
+	// As dbscan::extractDBSCAN: 0 is noise, and clusters are numbered from 1 in the order they are reached.
+	void dbscan(const double& epsCl, int* clusters) const {
+		int cluster = 0;
+		for (long long i = 0; i != N; ++i) {
+			int& label = clusters[order[i]];
+			if (reach[i] > epsCl) label = (core[i] <= epsCl) ? ++cluster : 0;
+			else label = cluster;
 		}
 	}
 
-	void runQueue() {
-		PairingHeap<long long, double> seeds(N);
-		while (! seedQueue.empty() && progress.increment()) {
-			const long long p = seedQueue.top().second;
-			seedQueue.pop();
-			if (visited[p]) continue;
-			runOne(p, seeds);
+	/*
+	 * The steep-area method of Ankerst et al., without predecessor correction. Each cluster is
+	 * a pair of positions, first and last inclusive; clusters may nest. A point is labelled with
+	 * the smallest cluster that contains it, with clusters numbered from 1 in the order returned.
+	 */
+	vector< pair< long long, long long > > xi(const double& xi, const unsigned int& minPts, int* clusters) const {
+		const double ixi = 1 - xi;
+		vector< SteepDownArea > areas;
+		vector< pair< long long, long long > > found;
+		double mib = 0;
+		long long i = 0;
+		while (i < N) {
+			mib = max(mib, reach[i]);
+			if (steepDown(i, ixi)) {
+				filterAreas(areas, mib, ixi);
+				const long long start = i;
+				long long end = i;
+				for (++i; i < N; ++i) {
+					if (steepDown(i, ixi)) end = i;
+					else if (reachAt(i) < reachAt(i + 1) || i - end > minPts) break;
+				}
+				areas.push_back({start, end, reach[start], 0});
+				mib = 0;
+				i = end + 1;
+			} else if (steepUp(i, ixi)) {
+				filterAreas(areas, mib, ixi);
+				const long long start = i;
+				long long end = i;
+				double successor = reachAt(i + 1);
+				if (successor != INFINITY) for (++i; i < N; ++i) {
+					if (steepUp(i, ixi)) {
+						end = i;
+						successor = reachAt(i + 1);
+						if (successor == INFINITY) break;
+					} else if (reachAt(i) > reachAt(i + 1) || i - end > minPts) break;
+				}
+				for (auto sda = areas.rbegin(); sda != areas.rend(); ++sda) {
+					if (successor * ixi < sda->mib) continue;
+					long long first = sda->start, last = end;
+					if (sda->maximum * ixi >= successor) {
+						while (first < sda->end && reach[first + 1] > successor) ++first;
+					} else if (successor * ixi >= sda->maximum) {
+						while (last > start && reach[last] > sda->maximum) --last;
+					}
+					if (last - first + 1 >= (long long) minPts) found.emplace_back(first, last);
+				}
+				mib = 0;
+				i = end + 1;
+			} else ++i;
 		}
-	}
-
-	List run() {
-		if (seedQueue.empty()) runAll();
-		else runQueue();
-		List ret;
-		ret["order"] = IntegerVector(orderedPoints.begin(), orderedPoints.end()) +1;
-		ret["reachdist"] = NumericVector(reachdist.begin(), reachdist.end());
-		ret["coredist"] = NumericVector(coredist.begin(), coredist.end());
-		ret["predecessor"] = IntegerVector(predecessor.begin(), predecessor.end()) + 1;
-		return ret;
+		sort(found.begin(), found.end(), [](const pair< long long, long long >& a, const pair< long long, long long >& b) {
+			return (a.first != b.first) ? a.first < b.first : a.second > b.second;
+		});
+		found.erase(unique(found.begin(), found.end()), found.end());
+
+		// Larger clusters are labelled first, so the smallest cluster containing each point is kept.
+		vector< int > bySize(found.size());
+		for (int c = 0; c != (int) found.size(); ++c) bySize[c] = c;
+		stable_sort(bySize.begin(), bySize.end(), [&found](const int& a, const int& b) {
+			return (found[a].second - found[a].first) > (found[b].second - found[b].first);
+		});
+		for (long long i = 0; i != N; ++i) clusters[order[i]] = 0;
+		for (auto c = bySize.begin(); c != bySize.end(); ++c) {
+			for (long long i = found[*c].first; i <= found[*c].second; ++i) clusters[order[i]] = *c + 1;
+		}
+		return found;
 	}
 };
 
 // [[Rcpp::export]]
-List optics_cpp(const arma::sp_mat& edges,
-                const arma::imat& neighbors,
-                const double& eps,
-                const int& minPts,
-                const bool& useQueue,
-                const bool& verbose) {
-	OPTICS opt = OPTICS(edges, neighbors, eps, minPts, verbose);
-	if (useQueue) opt.queue();
-	return opt.run();
-}
\ No newline at end of file
+List optics_extract_cpp(const IntegerVector& order,
+                        const NumericVector& reachdist,
+                        const NumericVector& coredist,
+                        const NumericVector& epsCl,
+                        const NumericVector& xi,
+                        const int& minPts,
+                        Rcpp::Nullable<Rcpp::NumericVector> threads) {
+#ifdef _OPENMP
+	checkCRAN(threads);
+#endif
+	for (auto it = xi.begin(); it != xi.end(); ++it) if (*it <= 0 || *it >= 1) throw Rcpp::exception("xi must be in (0, 1).");
+	const OPTICSExtractor extractor(order, reachdist, coredist);
+	const int N = reachdist.size(), E = epsCl.size(), X = xi.size();
+	IntegerMatrix dbscanClusters(N, E);
+	IntegerMatrix xiClusters(N, X);
+	int* dbscanOut = dbscanClusters.begin();
+	int* xiOut = xiClusters.begin();
+	const vector< double > epsValues(epsCl.begin(), epsCl.end());
+	const vector< double > xiValues(xi.begin(), xi.end());
+	vector< vector< pair< long long, long long > > > xiFound(X);
+	// Each column is a single pass over the ordering.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+	for (int c = 0; c < E + X; ++c) {
+		if (c < E) extractor.dbscan(epsValues[c], dbscanOut + (long long) c * N);
+		else xiFound[c - E] = extractor.xi(xiValues[c - E], minPts, xiOut + (long long) (c - E) * N);
+	}
+	List intervals(X);
+	for (int x = 0; x != X; ++x) {
+		IntegerMatrix found(xiFound[x].size(), 2);
+		for (int c = 0; c != (int) xiFound[x].size(); ++c) {
+			found(c, 0) = xiFound[x][c].first + 1;
+			found(c, 1) = xiFound[x][c].second + 1;
+		}
+		intervals[x] = found;
+	}
+	return List::create(Named("dbscan") = dbscanClusters,
+                      Named("xi") = xiClusters,
+                      Named("clusters_xi") = intervals);
+}
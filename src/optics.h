@@ -0,0 +1,191 @@
+#ifndef _LARGEVISOPTICS
+#define _LARGEVISOPTICS
+#include "largeVis.h"
+#include "minindexedpq.h"
+#include <queue>
+#include <progress.hpp>
+#include "neighborgraph.h"
+#include "profiler.h"
+
+using namespace std;
+using namespace arma;
+
+/*
+ * The result of OPTICS, with points indexed from 0: the points in the order visited, each point's
+ * reachability and core distances, infinite where undefined, and the point from which each was
+ * reached, or NA_INTEGER. The counters are those reported in the profile.
+ */
+struct OPTICSOrdering {
+	vector< long long > order;
+	vector< double > reachdist, coredist;
+	vector< long long > predecessor;
+	long long heapInserts, heapDecreases, heapPops, neighborLookups;
+};
+
+/*
+ * Seeds are kept in an indexed d-ary heap, which pops tied reachability distances in decreasing
+ * order of index. The operations on it, and the neighbor entries read from the graph, are counted
+ * so that their cost per point can be reported.
+ */
+class OPTICS {
+protected:
+	const NeighborGraph* graph;
+	const double eps;
+	const long long N;
+
+	bool* visited;
+	vector< long long > orderedPoints;
+	vector< double > reachdist, coredist;
+	priority_queue< pair<double, long> > seedQueue;
+	vector< long long > predecessor;
+
+	long long heapInserts = 0, heapDecreases = 0, heapPops = 0, neighborLookups = 0;
+
+	Progress progress;
+
+	long double reachabilityDistance(const long long& p,
+                                  			 const double& dist) const {
+		return max(coredist[p], dist);
+	}
+
+	void getNeighbors(const long long& p,
+                    DaryHeap< long long, double >& seeds) {
+		bool exceeded = false;
+		for (auto it = graph->beginNeighbors(p);
+       	 it != graph->endNeighbors(p);
+       	 it++) {
+			neighborLookups++;
+			if (visited[it->neighbor]) continue;
+			if (it->distance < eps) addNeighbor(p, it->neighbor, it->distance, seeds);
+			else {
+				exceeded = true;
+				break;
+			}
+		}
+		if (! exceeded) for (auto it = graph->beginReverse(p);
+                         it != graph->endReverse(p);
+                         it++) {
+			neighborLookups++;
+			if (! visited[it->neighbor] && it->distance < eps) addNeighbor(p, it->neighbor, it->distance, seeds);
+		}
+	}
+
+	void addNeighbor(const long long& p,
+                   const long long& q,
+                   const double& dist,
+                   DaryHeap< long long, double >& seeds) {
+		if (visited[q]) return;
+		const double newReachabilityDistance = reachabilityDistance(p, dist);
+
+		if (! seeds.contains(q)) {
+			heapInserts++;
+			seeds.insert(q, newReachabilityDistance);
+			predecessor[q] = p;
+		} else if (seeds.decreaseIf(q, newReachabilityDistance)) {
+			heapDecreases++;
+			predecessor[q] = p;
+		}
+	}
+
+public:
+	OPTICS(const NeighborGraph& graph,
+         const double& eps,
+         const unsigned int& minPts,
+         const bool& verbose) : graph{&graph},
+         								 eps{eps}, N(graph.size()),
+         								 visited(new bool[N]),
+								         orderedPoints(vector<long long>()),
+								         reachdist(vector< double >(N, INFINITY)),
+								         coredist(vector< double >(N)),
+								         predecessor(vector< long long >(N, NA_INTEGER)),
+								         progress(Progress(N, verbose)) {
+         	if (graph.neighborsPerVertex() < minPts) throw LargeVisError("Insufficient neighbors.");
+         	if (minPts < 2) throw LargeVisError("minPts must be >= 2");
+         	orderedPoints.reserve(N);
+         	for (long long n = 0; n != N; n++) {
+         		double nthDistance = (graph.countNeighbors(n) < minPts - 1) ? INFINITY : graph.neighbor(n, minPts - 2).distance;
+         		visited[n] = false;
+         		coredist[n] = (nthDistance < eps) ? nthDistance : INFINITY;
+         	}
+        }
+
+	~OPTICS() {
+		delete[] visited;
+	}
+
+	void queue() {
+		for (long long n = 0; n != N; n++) {
+			seedQueue.emplace(coredist[n], n);
+		}
+	}
+
+	inline void runOne(const long long &p, DaryHeap< long long, double >& seeds) {
+		visited[p] = true;
+		orderedPoints.push_back(p);
+		if (coredist[p] == INFINITY) return; // core-dist is undefined
+		getNeighbors(p, seeds);
+		while (!seeds.isEmpty()) {
+			const long long q = seeds.pop();
+			const double key = seeds.keyOf(q);
+			heapPops++;
+			visited[q] = true;
+			orderedPoints.push_back(q);
+			reachdist[q] = key;
+			if (coredist[q] == INFINITY) continue;
+			getNeighbors(q, seeds);
+		}
+	}
+
+	void runAll() {
+		DaryHeap< long long, double > seeds(N);
+		for (long long p = 0; p != N && progress.increment(); p++) {
+			if (! visited[p]) runOne(p, seeds);
+		}
+	}
+
+	void runQueue() {
+		DaryHeap< long long, double > seeds(N);
+		while (! seedQueue.empty() && progress.increment()) {
+			const long long p = seedQueue.top().second;
+			seedQueue.pop();
+			if (visited[p]) continue;
+			runOne(p, seeds);
+		}
+	}
+
+	OPTICSOrdering run() {
+		if (seedQueue.empty()) runAll();
+		else runQueue();
+		OPTICSOrdering ret;
+		ret.order.assign(orderedPoints.begin(), orderedPoints.end());
+		ret.reachdist = reachdist;
+		ret.coredist = coredist;
+		ret.predecessor = predecessor;
+		ret.heapInserts = heapInserts;
+		ret.heapDecreases = heapDecreases;
+		ret.heapPops = heapPops;
+		ret.neighborLookups = neighborLookups;
+		return ret;
+	}
+};
+
+// Runs OPTICS on the graph, and adds its counters to the profile.
+inline OPTICSOrdering opticsOrdering(const NeighborGraph& graph,
+                                     const double& eps,
+                                     const int& minPts,
+                                     const bool& useQueue,
+                                     const bool& verbose,
+                                     Profiler& profiler = Profiler::none()) {
+	profiler.phase("core distances");
+	OPTICS opt = OPTICS(graph, eps, minPts, verbose);
+	if (useQueue) opt.queue();
+	profiler.phase("ordering");
+	OPTICSOrdering ret = opt.run();
+	profiler.count("points", graph.size());
+	profiler.count("heap_inserts", ret.heapInserts);
+	profiler.count("heap_decreases", ret.heapDecreases);
+	profiler.count("heap_pops", ret.heapPops);
+	profiler.count("neighbor_lookups", ret.neighborLookups);
+	return ret;
+}
+#endif
@@ -0,0 +1,165 @@
+#include "largeVis.h"
+#include <Rmath.h>
+
+using namespace Rcpp;
+using namespace std;
+using namespace arma;
+
+/*
+ * Outlier scores computed from each point's nearest neighbors and the distances to them, read
+ * directly from the edge matrix: column i holds the distances from point i to its neighbors. Nothing
+ * depends on the order of the neighbors within a column, so they need not be sorted.
+ *
+ * The per-point quantities the scores share are gathered in a single parallel pass over the edges
+ * when the object is built; each score is then at most one more pass.
+ */
+class KNNOutliers {
+protected:
+	const vertexidxtype N;
+	const uword* offsets;
+	const uword* neighbors;
+	const double* distances;
+	vector< double > kdist; // Distance to the farthest (kth) neighbor
+	vector< double > meandist;
+	vector< double > pdist; // Probabilistic set distance, lambda times the quadratic mean distance
+	vector< int > inDegree; // Number of points of which this is a neighbor
+
+	inline uword countNeighbors(const vertexidxtype& i) const {
+		return offsets[i + 1] - offsets[i];
+	}
+
+public:
+	KNNOutliers(const arma::sp_mat& edges, const double& lambda) : N(edges.n_cols),
+	                                                               offsets(edges.col_ptrs),
+	                                                               neighbors(edges.row_indices),
+	                                                               distances(edges.values),
+	                                                               kdist(vector< double >(N, 0)),
+	                                                               meandist(vector< double >(N, 0)),
+	                                                               pdist(vector< double >(N, 0)),
+	                                                               inDegree(vector< int >(N, 0)) {
+		if (edges.n_rows != edges.n_cols) throw Rcpp::exception("The edge matrix must be square.");
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (vertexidxtype i = 0; i < N; ++i) {
+			double sum = 0, squares = 0;
+			for (uword e = offsets[i]; e != offsets[i + 1]; ++e) {
+				const double d = distances[e];
+				kdist[i] = max(kdist[i], d);
+				sum += d;
+				squares += d * d;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+				inDegree[neighbors[e]]++;
+			}
+			meandist[i] = sum / countNeighbors(i);
+			pdist[i] = lambda * sqrt(squares / countNeighbors(i));
+		}
+	}
+
+	void knn(double* out) const {
+		for (vertexidxtype i = 0; i != N; ++i) out[i] = (countNeighbors(i) == 0) ? NA_REAL : kdist[i];
+	}
+
+	void avgknn(double* out) const {
+		for (vertexidxtype i = 0; i != N; ++i) out[i] = (countNeighbors(i) == 0) ? NA_REAL : meandist[i];
+	}
+
+	// The in-degree used by ODIN. Lower values are more outlying.
+	void indegree(double* out) const {
+		for (vertexidxtype i = 0; i != N; ++i) out[i] = inDegree[i];
+	}
+
+	/*
+	 * The local reachability density of each point is the inverse of its mean reachability distance
+	 * from its neighbors, max(kdist(o), d(i, o)); the LOF is the mean density of the neighbors relative
+	 * to the point's own. Points with no neighbors, or whose neighbors are all duplicates, get NA.
+	 */
+	void lof(double* out) const {
+		vector< double > lrd(N);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (vertexidxtype i = 0; i < N; ++i) {
+			double reach = 0;
+			for (uword e = offsets[i]; e != offsets[i + 1]; ++e) reach += max(kdist[neighbors[e]], distances[e]);
+			lrd[i] = countNeighbors(i) / reach;
+		}
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (vertexidxtype i = 0; i < N; ++i) {
+			double density = 0;
+			for (uword e = offsets[i]; e != offsets[i + 1]; ++e) density += lrd[neighbors[e]];
+			const double score = density / countNeighbors(i) / lrd[i];
+			out[i] = (std::isnan(score)) ? NA_REAL : score;
+		}
+	}
+
+	/*
+	 * Local outlier probabilities (LoOP), as in Kriegel et al. 2009. The probabilistic local outlier
+	 * factor compares each point's pdist to the mean of its neighbors', and is then normalized by
+	 * lambda times its quadratic mean over all points and passed through the error function.
+	 */
+	void loop(const double& lambda, double* out) const {
+		vector< double > plof(N);
+		double squares = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:squares)
+#endif
+		for (vertexidxtype i = 0; i < N; ++i) {
+			double expected = 0;
+			for (uword e = offsets[i]; e != offsets[i + 1]; ++e) expected += pdist[neighbors[e]];
+			plof[i] = pdist[i] / (expected / countNeighbors(i)) - 1;
+			if (std::isfinite(plof[i])) squares += plof[i] * plof[i];
+		}
+		const double nplof = lambda * sqrt(squares / N);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (vertexidxtype i = 0; i < N; ++i) {
+			out[i] = (std::isnan(plof[i])) ? NA_REAL : max(0.0, erf(plof[i] / (nplof * M_SQRT2)));
+		}
+	}
+};
+
+// [[Rcpp::export]]
+NumericVector lof_cpp(const arma::sp_mat& edges,
+                      Rcpp::Nullable<Rcpp::NumericVector> threads) {
+#ifdef _OPENMP
+	checkCRAN(threads);
+#endif
+	const KNNOutliers outliers(edges, 1);
+	NumericVector scores(edges.n_cols);
+	outliers.lof(scores.begin());
+	return scores;
+}
+
+// [[Rcpp::export]]
+NumericMatrix outlier_scores_cpp(const arma::sp_mat& edges,
+                                 const std::vector< std::string >& methods,
+                                 const double& lambda,
+                                 Rcpp::Nullable<Rcpp::NumericVector> threads) {
+#ifdef _OPENMP
+	checkCRAN(threads);
+#endif
+	for (auto it = methods.begin(); it != methods.end(); ++it) {
+		if (it->compare(string("lof")) != 0 && it->compare(string("knn")) != 0 && it->compare(string("avgknn")) != 0 &&
+        it->compare(string("loop")) != 0 && it->compare(string("indegree")) != 0) {
+			throw Rcpp::exception("Unknown outlier score.");
+		}
+	}
+	const KNNOutliers outliers(edges, lambda);
+	const long long N = edges.n_cols;
+	NumericMatrix scores(N, methods.size());
+	for (int m = 0; m != (int) methods.size(); ++m) {
+		double* out = scores.begin() + m * N;
+		if (methods[m].compare(string("lof")) == 0) outliers.lof(out);
+		else if (methods[m].compare(string("knn")) == 0) outliers.knn(out);
+		else if (methods[m].compare(string("avgknn")) == 0) outliers.avgknn(out);
+		else if (methods[m].compare(string("loop")) == 0) outliers.loop(lambda, out);
+		else outliers.indegree(out);
+	}
+	return scores;
+}
@@ -0,0 +1,76 @@
+#include "perfcounters.h"
+#include <cstring>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* const PerfCounters::names[PerfCounters::EVENTS] = {"cycles", "instructions", "llc_misses", "dtlb_misses"};
+
+#ifdef __linux__
+// Opens a counter of the calling thread, on whatever CPU it runs.
+static int openCounter(const unsigned int& type, const unsigned long long& config) {
+	struct perf_event_attr attributes;
+	memset(&attributes, 0, sizeof(attributes));
+	attributes.size = sizeof(attributes);
+	attributes.type = type;
+	attributes.config = config;
+	attributes.exclude_kernel = 1;
+	attributes.exclude_hv = 1;
+	attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+	return syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+
+static unsigned long long readMisses(const unsigned long long& cache) {
+	return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+}
+#endif
+
+PerfCounters::PerfCounters() {
+#ifdef _OPENMP
+	descriptors.assign(omp_get_max_threads() * EVENTS, -1);
+#else
+	descriptors.assign(EVENTS, -1);
+#endif
+#ifdef __linux__
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+#ifdef _OPENMP
+		const unsigned int thread = omp_get_thread_num();
+#else
+		const unsigned int thread = 0;
+#endif
+		if ((thread + 1) * EVENTS <= descriptors.size()) {
+			int* const own = descriptors.data() + thread * EVENTS;
+			own[0] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+			own[1] = openCounter(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+			own[2] = openCounter(PERF_TYPE_HW_CACHE, readMisses(PERF_COUNT_HW_CACHE_LL));
+			own[3] = openCounter(PERF_TYPE_HW_CACHE, readMisses(PERF_COUNT_HW_CACHE_DTLB));
+		}
+	}
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+	for (auto it = descriptors.begin(); it != descriptors.end(); ++it) if (*it >= 0) close(*it);
+#endif
+}
+
+vector< double > PerfCounters::read() const {
+	vector< double > counts(EVENTS, NA_REAL);
+#ifdef __linux__
+	for (vector< int >::size_type d = 0; d != descriptors.size(); ++d) {
+		if (descriptors[d] < 0) continue;
+		unsigned long long value[3]; // The count, the time enabled and the time running
+		if (::read(descriptors[d], value, sizeof(value)) != (ssize_t) sizeof(value)) continue;
+		double& count = counts[d % EVENTS];
+		if (ISNA(count)) count = 0;
+		if (value[2] != 0) count += value[0] * ((double) value[1] / value[2]);
+	}
+#endif
+	return counts;
+}
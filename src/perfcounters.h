@@ -0,0 +1,34 @@
+#ifndef _LARGEVISPERFCOUNTERS
+#define _LARGEVISPERFCOUNTERS
+#include "largeVis.h"
+#include <vector>
+
+using namespace std;
+
+/*
+ * Hardware event counts for every thread of the OpenMP team, from Linux perf_event_open: cycles,
+ * instructions, last-level cache read misses and data TLB read misses, in user space only.
+ *
+ * Each thread of the team opens its own counters, which count it whenever it runs, so the counts
+ * cover the parallel regions that reuse the team, which is how the OpenMP runtime normally runs
+ * them. An event that cannot be counted, because the hardware, the kernel's perf_event_paranoid
+ * setting or the platform does not allow it, reads as NA, and the others are still counted. When
+ * the kernel multiplexes the counters, the counts are scaled up to the time the events were enabled.
+ */
+class PerfCounters {
+private:
+	vector< int > descriptors; // EVENTS for each thread, or -1 for an event that could not be opened
+
+public:
+	static const unsigned int EVENTS = 4;
+	static const char* const names[EVENTS];
+
+	PerfCounters();
+	~PerfCounters();
+	PerfCounters(const PerfCounters&) = delete;
+	PerfCounters& operator=(const PerfCounters&) = delete;
+
+	// The count of each event so far, summed over the threads, or NA_REAL for those not counted.
+	vector< double > read() const;
+};
+#endif
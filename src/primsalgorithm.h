@@ -1,6 +1,9 @@
-#include <RcppArmadillo.h>
+#include "largeVis.h"
 #include "progress.hpp"
 #include "minindexedpq.h"
+#include "neighborgraph.h"
+#include "unionfind.h"
+#include <algorithm>
 
 template<class VIDX, class D>
 class PrimsAlgorithm {
@@ -31,8 +34,7 @@ public:
 		delete[] minimum_spanning_tree;
 	}
 
-	VIDX* run(const arma::sp_mat& edges,
-            const IntegerMatrix& neighbors,
+	VIDX* run(const NeighborGraph& graph,
             Progress& p,
             const VIDX& start) {
 		starterIndex = start;
@@ -44,16 +46,10 @@ public:
 			VIDX v = Q.pop();
 			if (! p.increment()) break;
 	//		if (Q.keyOf(v) == INFINITY || Q.keyOf(v) == -1) starterIndex = v;
-			IntegerVector vNeighbors = neighbors.column(v);
-			for (auto it = vNeighbors.begin();
-        it != vNeighbors.end() && *it != -1;
+			for (auto it = graph.begin(v);
+        it != graph.end(v);
         it++) {
-				updateVWD(v, *it, edges(v, *it));
-			}
-			for (auto it = edges.begin_col(v);
-        it != edges.end_col(v);
-        it++) {
-				updateVWD(v, it.row(), *it);
+				updateVWD(v, it->neighbor, it->distance);
 			}
 		}
 		return minimum_spanning_tree;
@@ -66,4 +62,104 @@ public:
 		sort(container.begin(), container.end());
 		return container;
 	}
-};
\ No newline at end of file
+};
+/*
+ * Runs Prim's algorithm on each connected component of the graph concurrently.
+ *
+ * Components are found with a concurrent union-find, whose root is the smallest vertex of each
+ * component, and each tree is grown from that vertex. Every component has its own heap, indexed
+ * by the vertices' positions within the component, so the heaps only cost memory in proportion
+ * to the components being processed. Components are scheduled largest first.
+ */
+template<class VIDX, class D, class HEAP = DaryHeap<VIDX, D> >
+class ComponentPrimsAlgorithm {
+private:
+	const VIDX N;
+	const D* coreDistances;
+	VIDX* minimum_spanning_tree;
+	D* keys;
+
+	// members holds the component's vertices in index order; localIndex maps each vertex to its position there.
+	void runComponent(const NeighborGraph& graph,
+                    const VIDX* members,
+                    const VIDX& size,
+                    const VIDX* localIndex,
+                    Progress& p) {
+		HEAP Q(size);
+		Q.batchInsert(size, 0);
+		while (! Q.isEmpty()) {
+			const VIDX v = members[Q.pop()];
+			if (! p.increment()) break;
+			for (auto it = graph.begin(v); it != graph.end(v); ++it) {
+				const VIDX w = it->neighbor;
+				if (! Q.contains(localIndex[w])) continue;
+				const D dist = fmax(it->distance, std::max(coreDistances[v], coreDistances[w]));
+				if (Q.decreaseIf(localIndex[w], dist)) minimum_spanning_tree[w] = v;
+			}
+		}
+		for (VIDX i = 0; i != size; ++i) keys[members[i]] = Q.keyOf(i);
+	}
+
+public:
+	ComponentPrimsAlgorithm(const VIDX& N, const D* coreDistances) : N{N}, coreDistances{coreDistances} {
+		minimum_spanning_tree = new VIDX[N];
+		keys = new D[N];
+	}
+
+	ComponentPrimsAlgorithm(const ComponentPrimsAlgorithm& p) : ComponentPrimsAlgorithm(p.N, p.coreDistances) {};
+
+	~ComponentPrimsAlgorithm() {
+		delete[] minimum_spanning_tree;
+		delete[] keys;
+	}
+
+	VIDX* run(const NeighborGraph& graph, Progress& p) {
+		ConcurrentUnionFind<VIDX> components(N);
+		std::vector< VIDX > componentOf(N);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (VIDX v = 0; v < N; ++v) {
+			minimum_spanning_tree[v] = NA_INTEGER;
+			for (auto it = graph.begin(v); it != graph.end(v); ++it) components.unite(v, it->neighbor);
+		}
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for (VIDX v = 0; v < N; ++v) componentOf[v] = components.find(v);
+
+		// Group the vertices by component, in index order, with each component starting at its root.
+		std::vector< VIDX > offsets(N + 1, 0);
+		for (VIDX v = 0; v != N; ++v) offsets[componentOf[v] + 1]++;
+		for (VIDX v = 0; v != N; ++v) offsets[v + 1] += offsets[v];
+		std::vector< VIDX > members(N), localIndex(N);
+		std::vector< VIDX > fill(offsets.begin(), offsets.end() - 1);
+		for (VIDX v = 0; v != N; ++v) {
+			const VIDX c = componentOf[v];
+			localIndex[v] = fill[c] - offsets[c];
+			members[fill[c]++] = v;
+		}
+		std::vector< VIDX > roots;
+		for (VIDX v = 0; v != N; ++v) if (componentOf[v] == v) roots.push_back(v);
+		std::sort(roots.begin(), roots.end(), [&offsets](const VIDX& a, const VIDX& b) {
+			return (offsets[a + 1] - offsets[a]) > (offsets[b + 1] - offsets[b]);
+		});
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 1)
+#endif
+		for (VIDX r = 0; r < (VIDX) roots.size(); ++r) {
+			const VIDX root = roots[r];
+			runComponent(graph, members.data() + offsets[root], offsets[root + 1] - offsets[root], localIndex.data(), p);
+		}
+		return minimum_spanning_tree;
+	}
+
+	std::vector< std::pair<D, VIDX> > getMergeSequence() const {
+		std::vector< std::pair<D, VIDX> > container;
+		container.reserve(N);
+		for (VIDX n = 0; n != N; ++n) container.emplace_back(keys[n], n);
+		sort(container.begin(), container.end());
+		return container;
+	}
+};
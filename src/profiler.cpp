@@ -0,0 +1,196 @@
+#include "profiler.h"
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+
+ThreadCounter::ThreadCounter() {
+	overflow.value = 0;
+#ifdef _OPENMP
+	slots.assign(omp_get_max_threads(), Slot());
+#else
+	slots.assign(1, Slot());
+#endif
+}
+
+double ThreadCounter::total() const {
+	double sum = overflow.value;
+	for (auto it = slots.begin(); it != slots.end(); ++it) sum += it->value;
+	return sum;
+}
+
+vector< double > ThreadCounter::perThread() const {
+	vector< double > values;
+	for (auto it = slots.begin(); it != slots.end(); ++it) values.push_back(it->value);
+	return values;
+}
+
+Profiler::Profiler(const bool& enabled, const string& tracePath, const bool& hardware) :
+	enabled{enabled}, tracePath{tracePath}, tracing(! tracePath.empty()) {
+	if (enabled && hardware) {
+		perf.reset(new PerfCounters());
+		phasePerf.resize(PerfCounters::EVENTS);
+	}
+	if (tracing) {
+#ifdef _OPENMP
+		rings.resize(omp_get_max_threads());
+#else
+		rings.resize(1);
+#endif
+		for (auto it = rings.begin(); it != rings.end(); ++it) it->events.resize(RINGSIZE);
+	}
+}
+
+#ifndef LARGEVIS_STANDALONE
+static string traceOption() {
+	SEXP path = Rf_GetOption1(Rf_install("largeVis.trace"));
+	if (! Rf_isString(path) || Rf_length(path) != 1 || STRING_ELT(path, 0) == NA_STRING) return string();
+	return string(CHAR(STRING_ELT(path, 0)));
+}
+
+static bool logicalOption(const char* name) {
+	return Rf_asLogical(Rf_GetOption1(Rf_install(name))) == TRUE;
+}
+
+Profiler::Profiler() : Profiler(logicalOption("largeVis.profile"), traceOption(), logicalOption("largeVis.perf")) {}
+#endif
+
+Profiler& Profiler::none() {
+	static Profiler disabled(false);
+	return disabled;
+}
+
+double Profiler::now() {
+	return std::chrono::duration< double >(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double Profiler::cpuNow() {
+	return (double) std::clock() / CLOCKS_PER_SEC;
+}
+
+void Profiler::phase(const string& name) {
+	if (! enabled && ! tracing) return;
+	end();
+	phaseNames.push_back(name);
+	inPhase = true;
+	if (perf) perfStart = perf->read();
+	wallStart = now();
+	cpuStart = cpuNow();
+}
+
+void Profiler::end() {
+	if (! inPhase) return;
+	phaseStart.push_back(wallStart);
+	phaseWall.push_back(now() - wallStart);
+	phaseCPU.push_back(cpuNow() - cpuStart);
+	if (perf) {
+		const vector< double > counts = perf->read();
+		for (unsigned int e = 0; e != PerfCounters::EVENTS; ++e) phasePerf[e].push_back(counts[e] - perfStart[e]);
+	}
+	inPhase = false;
+}
+
+void Profiler::count(const string& name, const double& value) {
+	if (! enabled) return;
+	for (vector< string >::size_type i = 0; i != counterNames.size(); ++i) if (counterNames[i] == name) {
+		counterValues[i] += value;
+		return;
+	}
+	counterNames.push_back(name);
+	counterValues.push_back(value);
+}
+
+void Profiler::count(const string& name, const ThreadCounter& counter) {
+	count(name, counter.total());
+}
+
+void Profiler::finish() {
+	end();
+	if (tracing) writeTrace();
+}
+
+void Profiler::write(std::ostream& out) const {
+	for (vector< string >::size_type i = 0; i != phaseNames.size(); ++i) {
+		out << "phase\t" << phaseNames[i] << "\twall " << phaseWall[i] << "\tcpu " << phaseCPU[i];
+		if (perf) for (unsigned int e = 0; e != PerfCounters::EVENTS; ++e) {
+			out << "\t" << PerfCounters::names[e] << " " << phasePerf[e][i];
+		}
+		out << "\n";
+	}
+	for (vector< string >::size_type i = 0; i != counterNames.size(); ++i) {
+		out << "counter\t" << counterNames[i] << "\t" << counterValues[i] << "\n";
+	}
+	const vector< double > threadBusy = busy.perThread();
+	for (vector< double >::size_type t = 0; t != threadBusy.size(); ++t) {
+		out << "thread_busy\t" << t << "\t" << threadBusy[t] << "\n";
+	}
+}
+
+#ifndef LARGEVIS_STANDALONE
+Rcpp::List Profiler::report() const {
+	Rcpp::NumericVector counters(counterValues.begin(), counterValues.end());
+	counters.attr("names") = Rcpp::wrap(counterNames);
+	const vector< double > threadBusy = busy.perThread();
+	Rcpp::DataFrame phases;
+	if (perf) phases = Rcpp::DataFrame::create(Rcpp::Named("phase") = Rcpp::wrap(phaseNames),
+                                            Rcpp::Named("wall") = Rcpp::wrap(phaseWall),
+                                            Rcpp::Named("cpu") = Rcpp::wrap(phaseCPU),
+                                            Rcpp::Named(PerfCounters::names[0]) = Rcpp::wrap(phasePerf[0]),
+                                            Rcpp::Named(PerfCounters::names[1]) = Rcpp::wrap(phasePerf[1]),
+                                            Rcpp::Named(PerfCounters::names[2]) = Rcpp::wrap(phasePerf[2]),
+                                            Rcpp::Named(PerfCounters::names[3]) = Rcpp::wrap(phasePerf[3]),
+                                            Rcpp::Named("stringsAsFactors") = false);
+	else phases = Rcpp::DataFrame::create(Rcpp::Named("phase") = Rcpp::wrap(phaseNames),
+                                       Rcpp::Named("wall") = Rcpp::wrap(phaseWall),
+                                       Rcpp::Named("cpu") = Rcpp::wrap(phaseCPU),
+                                       Rcpp::Named("stringsAsFactors") = false);
+	return Rcpp::List::create(Rcpp::Named("phases") = phases,
+                            Rcpp::Named("counters") = counters,
+                            Rcpp::Named("thread_busy") = Rcpp::NumericVector(threadBusy.begin(), threadBusy.end()));
+}
+#endif
+
+void Profiler::record(const char* name, const double& start, const double& end) {
+#ifdef _OPENMP
+	const vector< Ring >::size_type thread = omp_get_thread_num();
+#else
+	const vector< Ring >::size_type thread = 0;
+#endif
+	if (thread >= rings.size()) return;
+	Ring& ring = rings[thread];
+	Event& event = ring.events[ring.recorded++ % RINGSIZE];
+	event.name = name;
+	event.start = start;
+	event.end = end;
+}
+
+static void writeEvent(std::ofstream& out, const string& name, const string& category, const unsigned int& thread,
+                       const double& start, const double& end) {
+	out << "{\"name\":\"" << name << "\",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread <<
+		",\"ts\":" << start * 1e6 << ",\"dur\":" << (end - start) * 1e6 << "},\n";
+}
+
+/*
+ * Appends this run's events to the trace file, starting the array if the file is new. Phases are
+ * shown on the master thread, around the spans they contain.
+ */
+void Profiler::writeTrace() const {
+	std::ofstream out(tracePath.c_str(), std::ios::app);
+	if (! out) {
+		largeVisWarning("Could not write the trace to " + tracePath);
+		return;
+	}
+	if (out.tellp() == 0) out << "[\n";
+	out << std::fixed << std::setprecision(3);
+	for (vector< string >::size_type i = 0; i != phaseWall.size(); ++i) {
+		writeEvent(out, phaseNames[i], "phase", 0, phaseStart[i], phaseStart[i] + phaseWall[i]);
+	}
+	for (unsigned int t = 0; t != rings.size(); ++t) {
+		const Ring& ring = rings[t];
+		const unsigned long first = (ring.recorded > RINGSIZE) ? ring.recorded - RINGSIZE : 0;
+		for (unsigned long e = first; e != ring.recorded; ++e) {
+			const Event& event = ring.events[e % RINGSIZE];
+			writeEvent(out, event.name, "work", t, event.start, event.end);
+		}
+	}
+}
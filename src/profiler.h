@@ -0,0 +1,176 @@
+#ifndef _LARGEVISPROFILER
+#define _LARGEVISPROFILER
+#include "largeVis.h"
+#include "perfcounters.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <ostream>
+
+using namespace std;
+
+/*
+ * Optional instrumentation of the C++ entry points, turned on with options(largeVis.profile = TRUE).
+ *
+ * A profiler divides a run into consecutive phases, and records the wall and CPU time of each. CPU
+ * time is that of the whole process, so it exceeds the wall time of a phase that keeps several
+ * threads busy. Counters are named totals, added once the work they count is done. Parallel loops
+ * add to ThreadCounters instead, and record the time each thread spends working with Profiler::Busy.
+ * The results are attached to the value returned to R as its "profile" attribute. With
+ * options(largeVis.perf = TRUE) as well, each phase also records the hardware events counted by
+ * PerfCounters.
+ *
+ * Setting options(largeVis.trace) to a file name also records a timeline: each phase, and each span of
+ * work marked with Profiler::Span, becomes an event on the thread that ran it. Each thread keeps its
+ * events in a ring buffer of its own, so that a long run keeps its most recent events without
+ * growing. The events are appended to the file in the JSON array form of the Chrome trace format,
+ * which may be left unterminated, so the entry points called by one R function add to one timeline.
+ *
+ * In the standalone build, which has no R options, the caller enables the profiler and names the
+ * trace file itself, and writes the report as text once the run is finished.
+ *
+ * A disabled profiler never reads the clock, so instrumentation left in place costs only a branch.
+ */
+
+// A total kept separately by each thread, so that parallel loops can add to it without synchronizing.
+class ThreadCounter {
+private:
+	// Each thread's sum in its own cache line.
+	struct Slot {
+		double value;
+		char padding[64 - sizeof(double)];
+	};
+	vector< Slot > slots;
+	// Shared by any thread numbered beyond the slots, as in a team larger than the thread count at
+	// construction, and added to atomically.
+	Slot overflow;
+
+public:
+	ThreadCounter();
+
+	inline void add(const double& n) {
+#ifdef _OPENMP
+		const vector< Slot >::size_type thread = omp_get_thread_num();
+		if (thread < slots.size()) slots[thread].value += n;
+		else {
+#pragma omp atomic
+			overflow.value += n;
+		}
+#else
+		slots[0].value += n;
+#endif
+	}
+
+	double total() const;
+	// The sums of the threads that have slots of their own.
+	vector< double > perThread() const;
+};
+
+class Profiler {
+private:
+	// A span of work on one thread, in seconds since an arbitrary epoch shared by all profilers.
+	struct Event {
+		const char* name;
+		double start, end;
+	};
+
+	// The most recent events of one thread.
+	struct Ring {
+		vector< Event > events;
+		unsigned long recorded = 0;
+		char padding[64];
+	};
+	static const unsigned long RINGSIZE = 1UL << 16;
+
+	const bool enabled;
+	const string tracePath;
+	const bool tracing;
+	vector< Ring > rings;
+	vector< string > phaseNames;
+	vector< double > phaseStart, phaseWall, phaseCPU;
+	unique_ptr< PerfCounters > perf;
+	vector< double > perfStart;
+	vector< vector< double > > phasePerf; // For each event, its count in each phase
+	vector< string > counterNames;
+	vector< double > counterValues;
+	ThreadCounter busy;
+	bool inPhase = false;
+	double wallStart = 0, cpuStart = 0;
+
+	static double cpuNow();
+	void record(const char* name, const double& start, const double& end);
+	void writeTrace() const;
+
+public:
+	explicit Profiler(const bool& enabled, const string& tracePath = string(), const bool& hardware = false);
+#ifndef LARGEVIS_STANDALONE
+	/*
+	 * Enabled if the largeVis.profile option is TRUE, and then counting hardware events if the
+	 * largeVis.perf option is also TRUE. Tracing if the largeVis.trace option names a file.
+	 */
+	Profiler();
+#endif
+
+	// A disabled profiler, for engines run without one.
+	static Profiler& none();
+	static double now();
+
+	inline bool isEnabled() const {
+		return enabled;
+	}
+
+	inline bool isTracing() const {
+		return tracing;
+	}
+
+	// Ends the current phase, if any, and starts the next.
+	void phase(const string& name);
+	void end();
+	// Adds to the named counter, which is created at zero the first time it is used.
+	void count(const string& name, const double& value);
+	void count(const string& name, const ThreadCounter& counter);
+
+	// Adds the time the calling thread spends in its scope to that thread's busy time.
+	class Busy {
+	private:
+		Profiler& profiler;
+		const double start;
+	public:
+		explicit Busy(Profiler& profiler) : profiler(profiler), start(profiler.enabled ? now() : 0) {}
+		~Busy() {
+			if (profiler.enabled) profiler.busy.add(now() - start);
+		}
+	};
+
+	// Records the calling thread's work in its scope as an event named name, which must be a literal.
+	class Span {
+	private:
+		Profiler& profiler;
+		const char* const name;
+		const double start;
+	public:
+		Span(Profiler& profiler, const char* name) : profiler(profiler), name(name), start(profiler.tracing ? now() : 0) {}
+		~Span() {
+			if (profiler.tracing) profiler.record(name, start, now());
+		}
+	};
+
+	// Ends the current phase, and writes the trace if tracing.
+	void finish();
+	// Writes the phases, counters and busy time as text, one line each.
+	void write(std::ostream& out) const;
+
+#ifndef LARGEVIS_STANDALONE
+	// Finishes, and if enabled wraps result with the report as its "profile" attribute.
+	template<class T>
+	SEXP attach(const T& result) {
+		Rcpp::RObject object = Rcpp::wrap(result);
+		finish();
+		if (enabled) object.attr("profile") = report();
+		return object;
+	}
+
+	Rcpp::List report() const;
+#endif
+};
+#endif
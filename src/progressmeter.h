@@ -0,0 +1,102 @@
+#ifndef _LARGEVISPROGRESSMETER
+#define _LARGEVISPROGRESSMETER
+#include <progress.hpp>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*
+ * Progress and cancellation for loops that count every item, reported through a Progress.
+ *
+ * Each thread counts the items it finishes in its own slot, without synchronizing. Every 1024 items,
+ * or whenever check() is called, the master thread adds what all the threads have counted since its
+ * last report to the Progress, at most once per interval; the Progress updates the display and looks
+ * for a user interrupt. An interrupt raises a flag that the other threads read at the same points, so
+ * every thread stops within a chunk of work. As with Progress, only the master thread can notice an
+ * interrupt, so a loop should give the master thread its share of the work.
+ *
+ * A meter serves a single loop, and is made just before it, since it has a slot for each thread
+ * that may run then; any thread beyond those shares an overflow slot. finish() reports the rest once
+ * the loop is done.
+ */
+class ProgressMeter {
+private:
+	static const unsigned int CHECKSHIFT = 10;
+
+	// Each thread's count in its own cache line. Only its owner writes it.
+	struct Slot {
+		std::atomic< unsigned long > count;
+		char padding[64 - sizeof(std::atomic< unsigned long >)];
+		Slot() : count(0) {}
+	};
+
+	Progress& progress;
+	std::vector< Slot > slots;
+	// Shared by any thread numbered beyond the slots, as in a team larger than the thread count when
+	// the meter was made, and added to atomically.
+	Slot overflow;
+	std::atomic< bool > aborted;
+	unsigned long reported = 0;
+	std::chrono::steady_clock::time_point lastReport;
+	const std::chrono::steady_clock::duration interval;
+
+	static inline int thread() {
+#ifdef _OPENMP
+		return omp_get_thread_num();
+#else
+		return 0;
+#endif
+	}
+
+	void report() {
+		unsigned long total = overflow.count.load(std::memory_order_relaxed);
+		for (auto it = slots.begin(); it != slots.end(); ++it) total += it->count.load(std::memory_order_relaxed);
+		lastReport = std::chrono::steady_clock::now();
+		if (! progress.increment(total - reported)) aborted.store(true, std::memory_order_relaxed);
+		reported = total;
+	}
+
+public:
+	explicit ProgressMeter(Progress& progress, const double& seconds = 0.1) :
+#ifdef _OPENMP
+		progress(progress), slots(omp_get_max_threads()),
+#else
+		progress(progress), slots(1),
+#endif
+		aborted(progress.is_aborted()),
+		lastReport(std::chrono::steady_clock::now()),
+		interval(std::chrono::duration_cast< std::chrono::steady_clock::duration >(std::chrono::duration< double >(seconds))) {}
+
+	// Counts n items finished by the calling thread. Returns false once the run has been interrupted.
+	inline bool increment(const unsigned long& n = 1) {
+		const std::vector< Slot >::size_type t = thread();
+		unsigned long before;
+		if (t < slots.size()) {
+			std::atomic< unsigned long >& count = slots[t].count;
+			before = count.load(std::memory_order_relaxed);
+			count.store(before + n, std::memory_order_relaxed);
+		} else before = overflow.count.fetch_add(n, std::memory_order_relaxed);
+		if ((before >> CHECKSHIFT) != ((before + n) >> CHECKSHIFT)) return check();
+		return ! aborted.load(std::memory_order_relaxed);
+	}
+
+	// Reports progress, if this is the master thread and the interval has passed. Returns false once the run has been interrupted.
+	inline bool check() {
+		if (aborted.load(std::memory_order_relaxed)) return false;
+		if (thread() == 0) {
+			if (std::chrono::steady_clock::now() - lastReport >= interval) report();
+		}
+		else if (progress.is_aborted()) aborted.store(true, std::memory_order_relaxed);
+		return ! aborted.load(std::memory_order_relaxed);
+	}
+
+	// Reports the items not yet reported. Returns false if the run was interrupted.
+	bool finish() {
+		report();
+		return ! aborted.load(std::memory_order_relaxed);
+	}
+};
+#endif
@@ -6,13 +6,24 @@
 /* .Call calls *//*
 extern SEXP largeVis_checkBits();
 extern SEXP largeVis_checkOpenMP();
-extern SEXP largeVis_dbscan_cpp(SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_dbscan_coords(SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_dbscan_cpp(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP largeVis_fastCDistance(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP largeVis_fastDistance(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP largeVis_fastSDistance(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
-extern SEXP largeVis_hdbscanc(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_hdbscanc(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_hdbscan_coords(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_hdbscan_sweepc(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_hdbscan_extractc(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_hdbscan_predictc(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_lof_cpp(SEXP, SEXP);
+extern SEXP largeVis_louvain_cpp(SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_optics_coords(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP largeVis_optics_cpp(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_optics_extract_cpp(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_outlier_scores_cpp(SEXP, SEXP, SEXP, SEXP);
 extern SEXP largeVis_referenceWij(SEXP, SEXP, SEXP, SEXP, SEXP);
+extern SEXP largeVis_searchKDTree(SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP largeVis_searchTrees(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP largeVis_searchTreesCSparse(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
 extern SEXP largeVis_searchTreesTSparse(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP);
@@ -21,13 +32,24 @@ extern SEXP largeVis_sgd(SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, SEXP, S
 static const R_CallMethodDef CallEntries[] = {
   {"largeVis_checkBits",          (DL_FUNC) &largeVis_checkBits,           0},
   {"largeVis_checkOpenMP",        (DL_FUNC) &largeVis_checkOpenMP,         0},
-  {"largeVis_dbscan_cpp",         (DL_FUNC) &largeVis_dbscan_cpp,          5},
+  {"largeVis_dbscan_coords",      (DL_FUNC) &largeVis_dbscan_coords,       5},
+  {"largeVis_dbscan_cpp",         (DL_FUNC) &largeVis_dbscan_cpp,          6},
   {"largeVis_fastCDistance",      (DL_FUNC) &largeVis_fastCDistance,       8},
   {"largeVis_fastDistance",       (DL_FUNC) &largeVis_fastDistance,        6},
   {"largeVis_fastSDistance",      (DL_FUNC) &largeVis_fastSDistance,       8},
-  {"largeVis_hdbscanc",           (DL_FUNC) &largeVis_hdbscanc,            6},
+  {"largeVis_hdbscanc",           (DL_FUNC) &largeVis_hdbscanc,            8},
+  {"largeVis_hdbscan_coords",     (DL_FUNC) &largeVis_hdbscan_coords,      8},
+  {"largeVis_hdbscan_sweepc",     (DL_FUNC) &largeVis_hdbscan_sweepc,      7},
+  {"largeVis_hdbscan_extractc",   (DL_FUNC) &largeVis_hdbscan_extractc,    9},
+  {"largeVis_hdbscan_predictc",   (DL_FUNC) &largeVis_hdbscan_predictc,   11},
+  {"largeVis_lof_cpp",            (DL_FUNC) &largeVis_lof_cpp,             2},
+  {"largeVis_louvain_cpp",        (DL_FUNC) &largeVis_louvain_cpp,         5},
+  {"largeVis_optics_coords",      (DL_FUNC) &largeVis_optics_coords,       6},
   {"largeVis_optics_cpp",         (DL_FUNC) &largeVis_optics_cpp,          6},
+  {"largeVis_optics_extract_cpp", (DL_FUNC) &largeVis_optics_extract_cpp,  7},
+  {"largeVis_outlier_scores_cpp", (DL_FUNC) &largeVis_outlier_scores_cpp,  4},
   {"largeVis_referenceWij",       (DL_FUNC) &largeVis_referenceWij,        5},
+  {"largeVis_searchKDTree",       (DL_FUNC) &largeVis_searchKDTree,        5},
   {"largeVis_searchTrees",        (DL_FUNC) &largeVis_searchTrees,         9},
   {"largeVis_searchTreesCSparse", (DL_FUNC) &largeVis_searchTreesCSparse, 11},
   {"largeVis_searchTreesTSparse", (DL_FUNC) &largeVis_searchTreesTSparse, 11},
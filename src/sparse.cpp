@@ -80,7 +80,8 @@ imat searchTreesSparse( const int& threshold,
 		annoy = new SparseEuclidean(data, K, p);
 	}
 
-	annoy->setSeed(seed);
+	const long innerSeed = seed.isNotNull() ? (long) NumericVector(seed)[0] : 0;
+	annoy->setSeed(seed.isNotNull() ? &innerSeed : nullptr);
 	annoy->trees(n_trees, threshold);
 	annoy->reduce();
 	annoy->exploreNeighborhood(maxIter);
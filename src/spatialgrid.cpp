@@ -0,0 +1,177 @@
+#include "spatialgrid.h"
+#include <queue>
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(const arma::mat& coords, const double& size) :
+	N(coords.n_cols), D(coords.n_rows), cellSize(size),
+	lower(vector< double >(D, INFINITY)), cells(vector< vertexidxtype >(3, 1)),
+	order(vector< vertexidxtype >(N)), sorted(vector< double >(N * D)),
+	cellOf(vector< vertexidxtype >(N)), positionOf(vector< vertexidxtype >(N)) {
+	if (D < 1 || D > 3) throw LargeVisError("The spatial grid only supports one to three dimensions.");
+	vector< double > upper(D, -INFINITY);
+	for (vertexidxtype i = 0; i != N; ++i) for (dimidxtype d = 0; d != D; ++d) {
+		if (! std::isfinite(coords(d, i))) throw LargeVisError("Coordinates must be finite.");
+		lower[d] = min(lower[d], coords(d, i));
+		upper[d] = max(upper[d], coords(d, i));
+	}
+	double extent = 0;
+	for (dimidxtype d = 0; d != D; ++d) extent = max(extent, upper[d] - lower[d]);
+	if (extent == 0) extent = 1;
+	// With no size given, start from about one cell per point along the widest dimension.
+	if (! (cellSize > 0)) cellSize = extent / max(N, (vertexidxtype) 1);
+	// Grow the cells until there are at most about four per point.
+	while (true) {
+		double total = 1;
+		for (dimidxtype d = 0; d != D; ++d) total *= floor((upper[d] - lower[d]) / cellSize) + 1;
+		if (total <= 4.0 * N + 16) break;
+		cellSize *= 2;
+	}
+	for (dimidxtype d = 0; d != D; ++d) cells[d] = (vertexidxtype) floor((upper[d] - lower[d]) / cellSize) + 1;
+	const vertexidxtype nCells = cells[0] * cells[1] * cells[2];
+
+	cellStart.assign(nCells + 1, 0);
+	for (vertexidxtype i = 0; i != N; ++i) {
+		vertexidxtype cell = 0;
+		for (dimidxtype d = D; d-- != 0;) {
+			const vertexidxtype at = min((vertexidxtype) floor((coords(d, i) - lower[d]) / cellSize), cells[d] - 1);
+			cell = cell * cells[d] + at;
+		}
+		cellOf[i] = cell;
+		cellStart[cell + 1]++;
+	}
+	for (vertexidxtype c = 0; c != nCells; ++c) cellStart[c + 1] += cellStart[c];
+	vector< vertexidxtype > fill(cellStart.begin(), cellStart.end() - 1);
+	for (vertexidxtype i = 0; i != N; ++i) {
+		const vertexidxtype position = fill[cellOf[i]]++;
+		order[position] = i;
+		positionOf[i] = position;
+		for (dimidxtype d = 0; d != D; ++d) sorted[position * D + d] = coords(d, i);
+	}
+}
+
+void SpatialGrid::cellCoordinates(const vertexidxtype& cell, vertexidxtype* at) const {
+	vertexidxtype rest = cell;
+	for (dimidxtype d = 0; d != 3; ++d) {
+		at[d] = rest % cells[d];
+		rest /= cells[d];
+	}
+}
+
+template<class F>
+void SpatialGrid::forRing(const vertexidxtype* at, const vertexidxtype& ring, F f) const {
+	vertexidxtype from[3], to[3];
+	for (dimidxtype d = 0; d != 3; ++d) {
+		from[d] = max(at[d] - ring, (vertexidxtype) 0);
+		to[d] = min(at[d] + ring, cells[d] - 1);
+	}
+	for (vertexidxtype z = from[2]; z <= to[2]; ++z) for (vertexidxtype y = from[1]; y <= to[1]; ++y) {
+		const bool inner = abs(z - at[2]) != ring && abs(y - at[1]) != ring;
+		for (vertexidxtype x = from[0]; x <= to[0]; ++x) {
+			// Only the first and last cells of an inner row are on the ring.
+			if (inner && x != at[0] - ring) {
+				if (at[0] + ring > to[0]) break;
+				x = at[0] + ring;
+			}
+			f((z * cells[1] + y) * cells[0] + x);
+		}
+	}
+}
+
+double SpatialGrid::distance(const vertexidxtype& position, const double* x) const {
+	double sum = 0;
+	for (dimidxtype d = 0; d != D; ++d) {
+		const double diff = sorted[position * D + d] - x[d];
+		sum += diff * diff;
+	}
+	return sqrt(sum);
+}
+
+static bool byDistance(const SpatialGrid::Edge& a, const SpatialGrid::Edge& b) {
+	return (a.distance != b.distance) ? a.distance < b.distance : a.neighbor < b.neighbor;
+}
+
+void SpatialGrid::range(const vertexidxtype& p, const double& eps, vector< Edge >& out) const {
+	out.clear();
+	const double* x = &sorted[positionOf[p] * D];
+	vertexidxtype at[3];
+	cellCoordinates(cellOf[p], at);
+	const vertexidxtype widest = max(cells[0], max(cells[1], cells[2]));
+	const vertexidxtype rings = min((vertexidxtype) ceil(eps / cellSize), widest);
+	for (vertexidxtype ring = 0; ring <= rings; ++ring) forRing(at, ring, [&](const vertexidxtype& cell) {
+		for (vertexidxtype i = cellStart[cell]; i != cellStart[cell + 1]; ++i) if (order[i] != p) {
+			const double d = distance(i, x);
+			if (d <= eps) out.push_back({order[i], d});
+		}
+	});
+	sort(out.begin(), out.end(), byDistance);
+}
+
+void SpatialGrid::knn(const vertexidxtype& p, const kidxtype& K, vector< Edge >& out) const {
+	out.clear();
+	const double* x = &sorted[positionOf[p] * D];
+	vertexidxtype at[3];
+	cellCoordinates(cellOf[p], at);
+	// The K nearest so far, farthest on top.
+	priority_queue< pair< double, vertexidxtype > > nearest;
+	const vertexidxtype widest = max(cells[0], max(cells[1], cells[2]));
+	for (vertexidxtype ring = 0; ring <= widest; ++ring) {
+		forRing(at, ring, [&](const vertexidxtype& cell) {
+			for (vertexidxtype i = cellStart[cell]; i != cellStart[cell + 1]; ++i) if (order[i] != p) {
+				const pair< double, vertexidxtype > candidate(distance(i, x), order[i]);
+				if (nearest.size() < K) nearest.push(candidate);
+				else if (candidate < nearest.top()) {
+					nearest.pop();
+					nearest.push(candidate);
+				}
+			}
+		});
+		// Points in the next ring are at least ring cells away.
+		if (nearest.size() == K && nearest.top().first <= ring * cellSize) break;
+	}
+	for (; ! nearest.empty(); nearest.pop()) out.push_back({nearest.top().second, nearest.top().first});
+	reverse(out.begin(), out.end());
+}
+
+NeighborGraph gridRangeGraph(const arma::mat& coords, const double& eps, const unsigned int& minPts) {
+	if (! (eps > 0) || ! std::isfinite(eps)) throw LargeVisError("eps must be positive and finite to search a spatial grid.");
+	const SpatialGrid grid(coords, eps);
+	const vertexidxtype N = coords.n_cols;
+	vector< vector< SpatialGrid::Edge > > rows(N);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		vector< SpatialGrid::Edge > found;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
+		for (vertexidxtype p = 0; p < N; ++p) {
+			grid.range(p, eps, found);
+			rows[p].assign(found.begin(), found.end());
+		}
+	}
+	kidxtype K = minPts;
+	for (vertexidxtype p = 0; p != N; ++p) K = max(K, (kidxtype) rows[p].size() + 1);
+	return NeighborGraph(rows, K, eps);
+}
+
+NeighborGraph gridKnnGraph(const arma::mat& coords, const kidxtype& K) {
+	if (K < 1 || (vertexidxtype) K >= (vertexidxtype) coords.n_cols) throw LargeVisError("K must be at least 1 and less than the number of points.");
+	const SpatialGrid grid(coords, 0);
+	const vertexidxtype N = coords.n_cols;
+	vector< vector< SpatialGrid::Edge > > rows(N);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		vector< SpatialGrid::Edge > found;
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 256)
+#endif
+		for (vertexidxtype p = 0; p < N; ++p) {
+			grid.knn(p, K, found);
+			rows[p].assign(found.begin(), found.end());
+		}
+	}
+	return NeighborGraph(rows, K);
+}
@@ -0,0 +1,54 @@
+#ifndef _LARGEVISSPATIALGRID
+#define _LARGEVISSPATIALGRID
+#include "largeVis.h"
+#include "neighborgraph.h"
+#include <vector>
+
+using namespace std;
+using namespace arma;
+
+/*
+ * Uniform grid over low-dimensional (D <= 3) coordinates, such as the output of projectKNNs,
+ * answering exact range and nearest-neighbor queries.
+ *
+ * The points are sorted by cell, and their coordinates copied in that order, so a query reads the
+ * points of each nearby cell contiguously. The cell size is grown if necessary so that there are
+ * never many more cells than points.
+ */
+class SpatialGrid {
+public:
+	typedef NeighborGraph::Edge Edge;
+
+private:
+	const vertexidxtype N;
+	const dimidxtype D;
+	double cellSize;
+	vector< double > lower;
+	vector< vertexidxtype > cells; // Number of cells along each dimension
+	vector< vertexidxtype > cellStart; // For each cell, the first position of its points
+	vector< vertexidxtype > order; // Point at each position
+	vector< double > sorted; // Coordinates of the point at each position
+	vector< vertexidxtype > cellOf; // Each point's cell
+	vector< vertexidxtype > positionOf; // Each point's position
+
+	void cellCoordinates(const vertexidxtype& cell, vertexidxtype* at) const;
+	// Visits the cells whose Chebyshev distance in cells from the given cell is exactly ring.
+	template<class F>
+	void forRing(const vertexidxtype* at, const vertexidxtype& ring, F f) const;
+	double distance(const vertexidxtype& position, const double* x) const;
+
+public:
+	// The points are the columns of coords.
+	SpatialGrid(const arma::mat& coords, const double& cellSize);
+
+	// Every point other than p within eps of it, sorted by distance.
+	void range(const vertexidxtype& p, const double& eps, vector< Edge >& out) const;
+	// The K points other than p nearest to it, sorted by distance.
+	void knn(const vertexidxtype& p, const kidxtype& K, vector< Edge >& out) const;
+};
+
+// The graph of all pairs within eps, for DBSCAN and OPTICS. K is at least minPts.
+NeighborGraph gridRangeGraph(const arma::mat& coords, const double& eps, const unsigned int& minPts);
+// The exact K-nearest-neighbor graph, for HDBSCAN.
+NeighborGraph gridKnnGraph(const arma::mat& coords, const kidxtype& K);
+#endif
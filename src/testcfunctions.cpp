@@ -2,6 +2,8 @@
 #include "largeVis.h"
 #include "alias.h"
 #include "gradients.h"
+#include "unionfind.h"
+#include "minindexedpq.h"
 
 // Initialize a unit test context. This is similar to how you
 // might begin an R test file with 'context()', expect the
@@ -113,3 +115,61 @@ context("gradient tests") {
 		expect_true(holder[1] == - holder[0]);
 	}
 };
+
+context("union find tests") {
+	test_that("union find joins sets") {
+		UnionFind<vertexidxtype> uf(10);
+		for (vertexidxtype n = 0; n < 9; n += 2) uf.unite(n, n + 1);
+		expect_true(uf.find(0) == uf.find(1));
+		expect_true(uf.find(0) != uf.find(2));
+		for (vertexidxtype n = 1; n < 9; n += 2) uf.unite(n, n + 1);
+		for (vertexidxtype n = 1; n != 10; n++) expect_true(uf.find(n) == uf.find(0));
+	}
+
+	test_that("union find returns the new root") {
+		UnionFind<vertexidxtype> uf(4);
+		const vertexidxtype root = uf.unite(2, 3);
+		expect_true(root == uf.find(2));
+		expect_true(uf.unite(0, 2) == uf.find(0));
+		expect_true(uf.unite(3, 2) == uf.find(3));
+	}
+};
+
+context("heap tests") {
+	test_that("d-ary heap pops in key order") {
+		DaryHeap<vertexidxtype, double> heap(10);
+		for (vertexidxtype n = 0; n != 10; n++) heap.insert(n, (n * 7) % 10);
+		double last = -1;
+		for (vertexidxtype n = 0; n != 10; n++) {
+			const vertexidxtype i = heap.pop();
+			expect_true(heap.keyOf(i) >= last);
+			expect_false(heap.contains(i));
+			last = heap.keyOf(i);
+		}
+		expect_true(heap.isEmpty());
+	}
+
+	test_that("d-ary heap decreases keys") {
+		DaryHeap<vertexidxtype, double> heap(10);
+		heap.batchInsert(10, 3);
+		expect_true(heap.pop() == 3);
+		expect_true(heap.decreaseIf(7, 2));
+		expect_false(heap.decreaseIf(7, 5));
+		expect_true(heap.decreaseIf(5, 1));
+		expect_true(heap.topKey() == 1);
+		expect_true(heap.pop() == 5);
+		expect_true(heap.pop() == 7);
+		expect_true(heap.size() == 7);
+	}
+
+	test_that("d-ary heap pops ties in decreasing order of index") {
+		DaryHeap<vertexidxtype, double> heap(10);
+		for (vertexidxtype n = 0; n != 10; n++) heap.insert(n, n % 2);
+		for (vertexidxtype n = 8; n >= 0; n -= 2) expect_true(heap.pop() == n);
+		DaryHeap<vertexidxtype, double> batch(10);
+		batch.batchInsert(10, 4);
+		expect_true(batch.pop() == 4);
+		expect_true(batch.pop() == 9);
+		expect_true(batch.pop() == 8);
+	}
+};
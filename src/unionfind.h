@@ -0,0 +1,103 @@
+#ifndef _LARGEVISUNIONFIND
+#define _LARGEVISUNIONFIND
+#include <atomic>
+#include <utility>
+
+/*
+ * Disjoint set over vertex indices, with path compression and union by rank.
+ */
+template<class VIDX>
+class UnionFind {
+private:
+	const VIDX N;
+	VIDX* parents;
+	unsigned char* ranks;
+
+public:
+	explicit UnionFind(const VIDX& N) : N{N} {
+		parents = new VIDX[N];
+		ranks = new unsigned char[N];
+		for (VIDX n = 0; n != N; ++n) {
+			parents[n] = n;
+			ranks[n] = 0;
+		}
+	}
+
+	UnionFind(const UnionFind& other) = delete;
+
+	~UnionFind() {
+		delete[] parents;
+		delete[] ranks;
+	}
+
+	VIDX find(VIDX x) {
+		VIDX root = x;
+		while (parents[root] != root) root = parents[root];
+		while (parents[x] != root) {
+			const VIDX next = parents[x];
+			parents[x] = root;
+			x = next;
+		}
+		return root;
+	}
+
+	// Joins the sets containing a and b, and returns the root of the combined set.
+	VIDX unite(VIDX a, VIDX b) {
+		a = find(a);
+		b = find(b);
+		if (a == b) return a;
+		if (ranks[a] < ranks[b]) std::swap(a, b);
+		else if (ranks[a] == ranks[b]) ranks[a]++;
+		parents[b] = a;
+		return a;
+	}
+};
+
+/*
+ * Lock-free disjoint set over vertex indices, for use inside omp parallel regions.
+ *
+ * Roots are always linked beneath the smaller root, so the root of every set is its
+ * smallest member regardless of the order in which threads perform their unions.
+ * Lookups halve paths as they go.
+ */
+template<class VIDX>
+class ConcurrentUnionFind {
+private:
+	const VIDX N;
+	std::atomic<VIDX>* parents;
+
+public:
+	explicit ConcurrentUnionFind(const VIDX& N) : N{N} {
+		parents = new std::atomic<VIDX>[N];
+		for (VIDX n = 0; n != N; ++n) parents[n].store(n, std::memory_order_relaxed);
+	}
+
+	ConcurrentUnionFind(const ConcurrentUnionFind& other) = delete;
+
+	~ConcurrentUnionFind() {
+		delete[] parents;
+	}
+
+	VIDX find(VIDX x) {
+		while (true) {
+			VIDX parent = parents[x].load();
+			if (parent == x) return x;
+			const VIDX grandparent = parents[parent].load();
+			if (parent != grandparent) parents[x].compare_exchange_weak(parent, grandparent);
+			x = grandparent;
+		}
+	}
+
+	// Returns true only for the call that actually joined the two sets.
+	bool unite(VIDX a, VIDX b) {
+		while (true) {
+			a = find(a);
+			b = find(b);
+			if (a == b) return false;
+			if (a < b) std::swap(a, b);
+			VIDX expected = a;
+			if (parents[a].compare_exchange_strong(expected, b)) return true;
+		}
+	}
+};
+#endif
@@ -0,0 +1,80 @@
+#include "visualizer.h"
+
+#define BATCHSIZE 8192
+
+void optimizeCoordinates(arma::mat& coords,
+                         arma::ivec& targets_i,
+                         arma::ivec& sources_j,
+                         const arma::ivec& ps,
+                         const arma::vec& weights,
+                         const double& gamma,
+                         const double& rho,
+                         const arma::uword& n_samples,
+                         const int& M,
+                         const double& alpha,
+                         const float* momentum,
+                         const bool& useDegree,
+                         const long* seed,
+                         const bool& verbose,
+                         Profiler& profiler) {
+	const dimidxtype D = coords.n_rows;
+	const vertexidxtype N = coords.n_cols;
+	const edgeidxtype E = targets_i.n_elem;
+	profiler.count("vertices", N);
+	profiler.count("edges", E);
+	profiler.phase("alias tables");
+
+	Visualizer* v;
+	if (momentum == nullptr) v = new Visualizer(
+			sources_j.memptr(), targets_i.memptr(), coords.memptr(),
+     	D, N, E,
+     	rho, n_samples,
+     	M, alpha, gamma);
+	else {
+		const float moment = *momentum;
+		if (moment < 0) throw LargeVisError("Momentum cannot be negative.");
+		if (moment > 0.95) throw LargeVisError("Bad things happen when momentum is > 0.95.");
+		v = new MomentumVisualizer(
+			 sources_j.memptr(), targets_i.memptr(), coords.memptr(),
+	     D, N, E,
+	     rho, n_samples, moment,
+	     M, alpha, gamma);
+	}
+
+	distancetype* negweights = new distancetype[N];
+	std::fill(negweights, negweights + N, 0);
+	if (useDegree) {
+		std::for_each(targets_i.begin(), targets_i.end(), [&negweights](const sword& e) {negweights[e]++;});
+	} else {
+		for (vertexidxtype p = 0; p < N; ++p) {
+			for (edgeidxtype e = ps[p]; e != ps[p + 1]; ++e) {
+				negweights[p] += weights[e];
+			}
+		}
+	}
+	std::for_each(negweights, negweights + N, [](distancetype& weight) {weight = pow(weight, 0.75);});
+	v -> initAlias(weights.memptr(), negweights, seed);
+	delete[] negweights;
+
+	const uword batchSize = BATCHSIZE;
+#ifdef _OPENMP
+	const unsigned int ts = omp_get_max_threads();
+#else
+	const unsigned int ts = 2;
+#endif
+	Progress progress(max((uword) ts, n_samples / BATCHSIZE), verbose);
+	profiler.phase("gradient descent");
+	ThreadCounter samples;
+	ProgressMeter meter(progress);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (unsigned int t = 0; t < ts; ++t) {
+		Profiler::Busy busy(profiler);
+		samples.add(v->thread(meter, profiler, batchSize));
+	}
+	meter.finish();
+	profiler.count("samples", samples);
+	profiler.count("negative_samples", samples.total() * M);
+	delete v;
+}
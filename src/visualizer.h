@@ -0,0 +1,237 @@
+#ifndef _LARGEVISVISUALIZER
+#define _LARGEVISVISUALIZER
+#include "largeVis.h"
+#include "alias.h"
+#include "progress.hpp"
+#include "gradients.h"
+#include "profiler.h"
+#include "progressmeter.h"
+
+using namespace std;
+using namespace arma;
+
+class Visualizer {
+private:
+	inline void updateMinus(const coordinatetype * const from,
+                          coordinatetype * const to,
+                          const distancetype& rho) {
+		for (dimidxtype d = 0; d != D; ++d) to[d] -= from[d] * rho;
+	}
+protected:
+	const dimidxtype D;
+	const unsigned int M;
+
+	vertexidxtype * const targetPointer;
+	vertexidxtype * const sourcePointer;
+	coordinatetype * const coordsPtr;
+
+	double rho;
+	const double rhoIncrement;
+
+	AliasTable< vertexidxtype, coordinatetype, double > negAlias;
+	AliasTable< edgeidxtype, coordinatetype, double > posAlias;
+	Gradient* grad;
+
+	unsigned int storedThreads = 0;
+
+public:
+	Visualizer(vertexidxtype *sourcePtr,
+            vertexidxtype *targetPtr,
+            coordinatetype *coordPtr,
+
+            const dimidxtype& D,
+            const vertexidxtype& N,
+            const edgeidxtype& E,
+
+            double rho,
+            const iterationtype& n_samples,
+
+            const unsigned int& M,
+            const double& alpha,
+            const double& gamma) : D{D}, M{M},
+	            targetPointer{targetPtr},
+	            sourcePointer{sourcePtr},
+	            coordsPtr{coordPtr},
+	            rho{rho},
+	            rhoIncrement((rho - 0.0001) / n_samples),
+	            negAlias(AliasTable< vertexidxtype, coordinatetype, double >(N)),
+	            posAlias(AliasTable< edgeidxtype, coordinatetype, double >(E)){
+    	if (alpha == 0) grad = new ExpGradient(gamma, D);
+    	else if (alpha == 1) grad = new AlphaOneGradient(gamma, D);
+    	else grad = new AlphaGradient(alpha, gamma, D);
+    }
+	virtual ~Visualizer() {
+#ifdef _OPENMP
+		if (storedThreads > 0) omp_set_num_threads(storedThreads);
+#endif
+		delete grad;
+	}
+
+	void initAlias(const distancetype* posWeights,
+                 const distancetype* negWeights,
+                const long* seed) {
+		negAlias.initialize(negWeights);
+		posAlias.initialize(posWeights);
+
+		if (seed != nullptr) {
+#ifdef _OPENMP
+			storedThreads = omp_get_max_threads();
+			omp_set_num_threads(1);
+#endif
+			long innerSeed = negAlias.initRandom(*seed);
+			posAlias.initRandom(innerSeed);
+		} else {
+			negAlias.initRandom();
+			posAlias.initRandom();
+		}
+	}
+
+	virtual void innerLoop(const double& localRho,
+                        const unsigned int& batchSize,
+                        coordinatetype * const firstholder) {
+		coordinatetype * const secondholder = firstholder + D;
+		for (unsigned int example = 0; example != batchSize; ++example) {
+
+			const edgeidxtype e_ij = posAlias();
+			const vertexidxtype j = targetPointer[e_ij];
+			const vertexidxtype i = sourcePointer[e_ij];
+
+			coordinatetype * const y_i = coordsPtr + (i * D);
+			coordinatetype * y_j = coordsPtr + (j * D);
+			grad -> positiveGradient(y_i, y_j, firstholder);
+			updateMinus(firstholder, y_j, localRho);
+
+			unsigned int m = 0;
+			while (m != M) {
+				const vertexidxtype k =  negAlias();
+
+				// Check that the draw isn't one of i's edges
+				if (k == i || k == j) continue;
+				m++;
+
+				y_j = coordsPtr + (k * D);
+				grad -> negativeGradient(y_i, y_j, secondholder);
+
+				updateMinus(secondholder, y_j, localRho);
+				for (dimidxtype d = 0; d != D; ++d) firstholder[d] += secondholder[d];
+			}
+			updateMinus(firstholder, y_i, - localRho);
+		}
+	}
+
+	// Returns the number of positive samples processed.
+	iterationtype thread(ProgressMeter& meter, Profiler& profiler, const uword& batchSize) {
+		coordinatetype * const holder = new coordinatetype[D * 2];
+		iterationtype samples = 0;
+
+		while (rho >= 0) {
+			const double localRho = rho;
+			{
+				Profiler::Span span(profiler, "sgd batch");
+				innerLoop(localRho, batchSize, holder);
+			}
+			samples += batchSize;
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+			rho -= (rhoIncrement * batchSize);
+			meter.increment();
+			if (! meter.check()) break;
+		}
+		delete[] holder;
+		return samples;
+	}
+};
+
+class MomentumVisualizer : public Visualizer {
+private:
+	inline void updateMinus(const coordinatetype* from, const vertexidxtype& i,
+                          coordinatetype* to, const distancetype& rho) {
+		coordinatetype* moment = momentumarray + (i * D);
+		for (dimidxtype d = 0; d != D; ++d) to[d] -= moment[d] = (moment[d] * momentum) + (from[d] * rho);
+	}
+protected:
+	float momentum;
+	coordinatetype* momentumarray;
+
+public:
+	MomentumVisualizer(vertexidxtype *sourcePtr,
+                    vertexidxtype *targetPtr,
+                    coordinatetype *coordPtr,
+
+                    const dimidxtype& D,
+                    const vertexidxtype& N,
+                    const edgeidxtype& E,
+
+                    double rho,
+                    const iterationtype& n_samples,
+                    const float& momentum,
+
+                    const unsigned int& M,
+                    const double& alpha,
+                    const double& gamma) : Visualizer(sourcePtr, targetPtr, coordPtr, D,
+                    																	N, E, rho, n_samples, M, alpha, gamma), momentum{momentum} {
+		momentumarray = new coordinatetype[D * N];
+		std::fill(momentumarray, momentumarray + D * N, 0);
+	}
+	~MomentumVisualizer() {
+		delete[] momentumarray;
+	}
+
+	virtual void innerLoop(const double& localRho, const unsigned int& batchSize,
+												 coordinatetype * const firstholder) {
+		coordinatetype * const secondholder = firstholder + D;
+		for (unsigned int example = 0; example != batchSize; ++example) {
+			const edgeidxtype e_ij = posAlias();
+			const vertexidxtype j = targetPointer[e_ij];
+			const vertexidxtype i = sourcePointer[e_ij];
+
+			coordinatetype* y_i = coordsPtr + (i * D);
+			coordinatetype* y_j = coordsPtr + (j * D);
+			grad -> positiveGradient(y_i, y_j, firstholder);
+			updateMinus(firstholder, j, y_j, localRho);
+
+			unsigned int m = 0;
+			while (m != M) {
+				const vertexidxtype k =  negAlias();
+
+				// Check that the draw isn't one of i's edges
+				if (k == i || k == j) continue;
+				m++;
+
+				y_j = coordsPtr + (k * D);
+				grad -> negativeGradient(y_i, y_j, secondholder);
+
+				updateMinus(secondholder, k, y_j, localRho);
+				for (dimidxtype d = 0; d != D; ++d) firstholder[d] += secondholder[d];
+			}
+			updateMinus(firstholder, i, y_i, - localRho);
+		}
+	}
+};
+
+/*
+ * Lays out the graph given by the symmetric weight matrix in compressed sparse column form, by
+ * stochastic gradient descent on the columns of coords: edge e runs from sources_j[e] to
+ * targets_i[e] with weight weights[e], and the edges of vertex j start at ps[j]. Each of the
+ * n_samples positive samples takes M negative samples, drawn in proportion to the vertices' degree,
+ * or weighted degree unless useDegree, to the power 0.75. With momentum, each update also adds that
+ * fraction of the last one. With a seed, the descent runs on a single thread, so that it can be
+ * reproduced.
+ */
+void optimizeCoordinates(arma::mat& coords,
+                         arma::ivec& targets_i,
+                         arma::ivec& sources_j,
+                         const arma::ivec& ps,
+                         const arma::vec& weights,
+                         const double& gamma,
+                         const double& rho,
+                         const arma::uword& n_samples,
+                         const int& M,
+                         const double& alpha,
+                         const float* momentum,
+                         const bool& useDegree,
+                         const long* seed,
+                         const bool& verbose,
+                         Profiler& profiler = Profiler::none());
+#endif
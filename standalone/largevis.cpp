@@ -0,0 +1,327 @@
+#include "largeVis.h"
+#include "densesearch.h"
+#include "referenceedges.h"
+#include "visualizer.h"
+#include "dbscan.h"
+#include "optics.h"
+#include "hdbscan.h"
+#include "spatialgrid.h"
+#include "matrixio.h"
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+
+using namespace std;
+using namespace arma;
+
+/*
+ * Command-line driver for the engines of the standalone build. Each command reads its inputs from
+ * matrix files, as described in matrixio.h, and writes one matrix file, with points indexed from 0:
+ *
+ *   neighbors  --data D --out F             The approximate nearest neighbors of each point, as
+ *                                           randomProjectionTreeSearch; K rows of integers.
+ *   embed      --data D --neighbors F --out C
+ *                                           The edge weights of buildWijMatrix, then the coordinates
+ *                                           of projectKNNs; dim rows of doubles.
+ *   dbscan     --data D [--neighbors F] --out L
+ *                                           The cluster of each point, from 1, or 0 for noise; one
+ *                                           row of integers.
+ *   optics     --data D [--neighbors F] --out O
+ *                                           Four rows of doubles: the point at each position of the
+ *                                           ordering, and each point's reachability distance, core
+ *                                           distance and predecessor, or -1.
+ *   hdbscan    --data D [--neighbors F] --out H
+ *                                           Four rows of doubles: each point's cluster, from 1, or 0
+ *                                           for noise, lambda, probability and GLOSH score.
+ *
+ * Without --neighbors, the clustering commands take coordinates in up to three dimensions and find
+ * their neighbors exactly with a spatial grid, as the R functions do given a matrix of coordinates.
+ * Any command accepts --threads, --verbose for a progress display, --profile to write the phases
+ * and counters of the run to standard error, --perf to add hardware counters to them, and --trace
+ * to append a Chrome trace of the run to a file.
+ */
+
+// The options given as --name value, or as --name alone for flags.
+class Options {
+private:
+	map< string, string > values;
+
+public:
+	Options(const int& argc, char** argv, const set< string >& flags) {
+		for (int a = 2; a < argc; ++a) {
+			const string arg(argv[a]);
+			if (arg.compare(0, 2, "--") != 0 || arg.size() == 2) throw LargeVisError("Unexpected argument " + arg);
+			const string name = arg.substr(2);
+			if (flags.count(name) != 0) values[name] = "1";
+			else if (a + 1 == argc) throw LargeVisError("Missing value for " + arg);
+			else values[name] = argv[++a];
+		}
+	}
+
+	bool has(const string& name) const {
+		return values.count(name) != 0;
+	}
+
+	string text(const string& name) const {
+		const auto it = values.find(name);
+		if (it == values.end()) throw LargeVisError("Missing --" + name);
+		return it->second;
+	}
+
+	string text(const string& name, const string& otherwise) const {
+		return has(name) ? text(name) : otherwise;
+	}
+
+	double number(const string& name) const {
+		const string value = text(name);
+		char* end;
+		const double number = strtod(value.c_str(), &end);
+		if (value.empty() || *end != '\0') throw LargeVisError("--" + name + " must be a number.");
+		return number;
+	}
+
+	double number(const string& name, const double& otherwise) const {
+		return has(name) ? number(name) : otherwise;
+	}
+};
+
+static bool isCosine(const Options& options) {
+	return options.text("distance", "Euclidean").compare(string("Cosine")) == 0;
+}
+
+// The distance from each point to each of its neighbors, at least 1e-5, as buildEdgeMatrix finds them.
+static vec edgeDistances(const mat& data, const imat& neighbors, const bool& cosine) {
+	vec distances(neighbors.n_elem);
+	distances.fill(NA_REAL);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for (vertexidxtype i = 0; i < (vertexidxtype) neighbors.n_cols; ++i) {
+		for (kidxtype k = 0; k != neighbors.n_rows && neighbors(k, i) != -1; ++k) {
+			const vec x_i = data.col(i), x_j = data.col(neighbors(k, i));
+			distances[i * neighbors.n_rows + k] = max(cosine ? cosDist(x_i, x_j) : dist(x_i, x_j), 1e-5);
+		}
+	}
+	return distances;
+}
+
+// The edge matrix, with the distance from each point to each of its neighbors in the point's row.
+static sp_mat edgeMatrix(const mat& data, const imat& neighbors, const bool& cosine) {
+	const vec distances = edgeDistances(data, neighbors, cosine);
+	vector< uword > rows, cols;
+	vector< double > values;
+	for (uword i = 0; i != neighbors.n_cols; ++i) {
+		for (uword k = 0; k != neighbors.n_rows && neighbors(k, i) != -1; ++k) {
+			rows.push_back(i);
+			cols.push_back(neighbors(k, i));
+			values.push_back(distances[i * neighbors.n_rows + k]);
+		}
+	}
+	umat locations(2, rows.size());
+	for (uword e = 0; e != rows.size(); ++e) {
+		locations(0, e) = rows[e];
+		locations(1, e) = cols[e];
+	}
+	return sp_mat(locations, vec(values), data.n_cols, data.n_cols);
+}
+
+static imat checkedNeighbors(const Options& options, const mat& data) {
+	const imat neighbors = readIntegerMatrix(options.text("neighbors"));
+	if (neighbors.n_cols != data.n_cols) throw LargeVisError("The data and neighbor matrices have different numbers of points.");
+	return neighbors;
+}
+
+static int neighbors(const Options& options, Profiler& profiler) {
+	const mat data = readMatrix(options.text("data"));
+	const long seed = (long) options.number("seed", 0);
+	const imat knns = denseNeighbors(data, options.text("distance", "Euclidean"),
+                                  options.number("K", 50),
+                                  options.number("trees", 50),
+                                  options.number("threshold", max(10, (int) data.n_rows)),
+                                  options.number("iterations", 1),
+                                  options.has("seed") ? &seed : nullptr,
+                                  options.has("verbose"), profiler);
+	if (Progress::check_abort()) return 130;
+	writeMatrix(options.text("out"), knns);
+	return 0;
+}
+
+static int embed(const Options& options, Profiler& profiler) {
+	const mat data = readMatrix(options.text("data"));
+	const imat knns = checkedNeighbors(options, data);
+	const vertexidxtype N = data.n_cols;
+	profiler.phase("distances");
+	const vec distances = edgeDistances(data, knns, isCosine(options));
+	ivec from, to;
+	vec squared;
+	{
+		vector< sword > i, j;
+		vector< double > d;
+		for (vertexidxtype v = 0; v != N; ++v) {
+			for (kidxtype k = 0; k != knns.n_rows && knns(k, v) != -1; ++k) {
+				i.push_back(v);
+				j.push_back(knns(k, v));
+				d.push_back(distances[v * knns.n_rows + k] * distances[v * knns.n_rows + k]);
+			}
+		}
+		from = ivec(i);
+		to = ivec(j);
+		squared = vec(d);
+	}
+	ReferenceEdges ref(options.number("perplexity", max(50.0, knns.n_rows / 3.0)), from, to, squared, profiler);
+	ref.run();
+	profiler.phase("matrix");
+	sp_mat wij = ref.getWIJ();
+	wij.sync();
+
+	const edgeidxtype E = wij.n_nonzero;
+	ivec targets_i(E), sources_j(E), ps(N + 1);
+	vec weights(E);
+	for (vertexidxtype j = 0; j <= N; ++j) ps[j] = wij.col_ptrs[j];
+	for (vertexidxtype j = 0; j != N; ++j) {
+		for (edgeidxtype e = ps[j]; e != ps[j + 1]; ++e) {
+			targets_i[e] = wij.row_indices[e];
+			sources_j[e] = j;
+			weights[e] = wij.values[e];
+		}
+	}
+
+	const long seed = (long) options.number("seed", 0);
+	const unsigned int D = options.number("dim", 2);
+	mt19937_64 mt;
+	if (options.has("seed")) mt.seed(seed);
+	else mt.seed(random_device()());
+	uniform_real_distribution< double > runif(0, 1);
+	mat coords(D, N);
+	for (auto it = coords.begin(); it != coords.end(); ++it) *it = (runif(mt) - 0.5) / D * 0.0001;
+
+	// As sgdBatches(N, E).
+	const double defaultSamples = (N < 10000) ? 2000.0 * E :
+		(N < 1000000) ? 1000000.0 * (9000.0 * (N - 10000) / (1000000 - 10000) + 1000) : N * 10000.0;
+	const float momentum = options.number("momentum", 0);
+	optimizeCoordinates(coords, targets_i, sources_j, ps, weights,
+                      options.number("gamma", 7), options.number("rho", 1),
+                      options.number("samples", defaultSamples),
+                      options.number("M", 5), options.number("alpha", 1),
+                      options.has("momentum") ? &momentum : nullptr, options.has("degree"),
+                      options.has("seed") ? &seed : nullptr, options.has("verbose"), profiler);
+	if (Progress::check_abort()) return 130;
+	writeMatrix(options.text("out"), coords);
+	return 0;
+}
+
+/*
+ * The graph to cluster: from the neighbor matrix if one is given, and otherwise from a spatial grid
+ * over the coordinates, of the pairs within eps or of each point's K nearest neighbors.
+ */
+static NeighborGraph clusteringGraph(const Options& options, const mat& data, const double& eps,
+                                     const int& minPts, const kidxtype& K, Profiler& profiler) {
+	profiler.phase("neighbor graph");
+	if (options.has("neighbors")) {
+		const imat knns = checkedNeighbors(options, data);
+		return NeighborGraph(edgeMatrix(data, knns, isCosine(options)), knns);
+	}
+	if (K == 0) return gridRangeGraph(data, eps, minPts);
+	return gridKnnGraph(data, K);
+}
+
+static int dbscan(const Options& options, Profiler& profiler) {
+	const mat data = readMatrix(options.text("data"));
+	const double eps = options.number("eps");
+	const int minPts = options.number("minPts");
+	const NeighborGraph graph = clusteringGraph(options, data, eps, minPts, 0, profiler);
+	DBSCAN db(graph, eps, minPts, options.has("verbose"), profiler);
+	const vector< int > clusters = db.run();
+	if (Progress::check_abort()) return 130;
+	imat out(1, clusters.size());
+	for (uword n = 0; n != clusters.size(); ++n) out[n] = clusters[n];
+	writeMatrix(options.text("out"), out);
+	return 0;
+}
+
+static int optics(const Options& options, Profiler& profiler) {
+	const mat data = readMatrix(options.text("data"));
+	const double eps = options.number("eps", INFINITY);
+	if (! options.has("neighbors") && ! std::isfinite(eps)) throw LargeVisError("eps must be finite to cluster coordinates.");
+	const int minPts = options.number("minPts");
+	const NeighborGraph graph = clusteringGraph(options, data, eps, minPts, 0, profiler);
+	const OPTICSOrdering ordering = opticsOrdering(graph, eps, minPts, ! options.has("noqueue"),
+                                                options.has("verbose"), profiler);
+	if (Progress::check_abort()) return 130;
+	mat out(4, graph.size());
+	for (vertexidxtype n = 0; n != graph.size(); ++n) {
+		out(0, n) = ordering.order[n];
+		out(1, n) = ordering.reachdist[n];
+		out(2, n) = ordering.coredist[n];
+		out(3, n) = (ordering.predecessor[n] == NA_INTEGER) ? -1 : ordering.predecessor[n];
+	}
+	writeMatrix(options.text("out"), out);
+	return 0;
+}
+
+static int hdbscan(const Options& options, Profiler& profiler) {
+	const mat data = readMatrix(options.text("data"));
+	const int K = options.number("K", 5);
+	const int minPts = options.number("minPts", 20);
+	const kidxtype graphK = min(max(K, 10), (int) data.n_cols - 1);
+	const NeighborGraph graph = clusteringGraph(options, data, INFINITY, minPts, graphK, profiler);
+	const HDBSCANResult result = hdbscanGraph(graph, K, minPts, options.text("mst", "Prim"), false,
+                                           options.has("verbose"), profiler);
+	if (Progress::check_abort()) return 130;
+	const HDBSCANClustering& clustering = result.clustering;
+	mat out(4, graph.size());
+	for (vertexidxtype n = 0; n != graph.size(); ++n) {
+		out(0, n) = (clustering.clusters[n] == NA_INTEGER) ? 0 : clustering.clusters[n];
+		out(1, n) = clustering.lambdas[n];
+		out(2, n) = clustering.probabilities[n];
+		out(3, n) = clustering.glosh[n];
+	}
+	writeMatrix(options.text("out"), out);
+	return 0;
+}
+
+static void usage() {
+	cerr << "usage: largevis <command> --data FILE [--neighbors FILE] --out FILE [options]\n"
+       "commands:\n"
+       "  neighbors  [--K 50] [--trees 50] [--threshold n] [--iterations 1] [--distance Euclidean|Cosine] [--seed s]\n"
+       "  embed      --neighbors FILE [--dim 2] [--perplexity p] [--samples n] [--M 5] [--gamma 7] [--alpha 1]\n"
+       "             [--rho 1] [--momentum m] [--degree] [--distance Euclidean|Cosine] [--seed s]\n"
+       "  dbscan     --eps e --minPts m [--distance Euclidean|Cosine]\n"
+       "  optics     --minPts m [--eps e] [--noqueue] [--distance Euclidean|Cosine]\n"
+       "  hdbscan    [--K 5] [--minPts 20] [--mst Prim|Boruvka|ParallelPrim] [--distance Euclidean|Cosine]\n"
+       "options for every command: [--threads n] [--verbose] [--profile] [--perf] [--trace FILE]\n";
+}
+
+int main(int argc, char** argv) {
+	if (argc < 2) {
+		usage();
+		return 2;
+	}
+	const string command(argv[1]);
+	try {
+		const Options options(argc, argv, {"verbose", "profile", "perf", "degree", "noqueue"});
+#ifdef _OPENMP
+		if (options.has("threads")) omp_set_num_threads(options.number("threads"));
+#endif
+		Profiler profiler(options.has("profile"), options.text("trace", string()), options.has("perf"));
+		int status;
+		if (command.compare(string("neighbors")) == 0) status = neighbors(options, profiler);
+		else if (command.compare(string("embed")) == 0) status = embed(options, profiler);
+		else if (command.compare(string("dbscan")) == 0) status = dbscan(options, profiler);
+		else if (command.compare(string("optics")) == 0) status = optics(options, profiler);
+		else if (command.compare(string("hdbscan")) == 0) status = hdbscan(options, profiler);
+		else {
+			usage();
+			return 2;
+		}
+		profiler.finish();
+		if (profiler.isEnabled()) profiler.write(cerr);
+		if (status == 130) cerr << "largevis: interrupted" << endl;
+		return status;
+	} catch (const std::exception& e) {
+		cerr << "largevis: " << e.what() << endl;
+		return 1;
+	}
+}
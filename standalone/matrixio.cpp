@@ -0,0 +1,91 @@
+#include "matrixio.h"
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+static const char MAGIC[4] = {'L', 'V', 'M', 'X'};
+static const uint32_t DOUBLES = 1, INTEGERS = 2;
+
+struct Header {
+	char magic[4];
+	uint32_t type;
+	uint64_t rows, cols;
+};
+
+static Header readHeader(std::ifstream& in, const std::string& path) {
+	Header header;
+	if (! in) throw LargeVisError("Cannot open " + path);
+	in.read((char*) &header, sizeof(header));
+	if (! in || memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) throw LargeVisError(path + " is not a largeVis matrix file.");
+	if (header.type != DOUBLES && header.type != INTEGERS) throw LargeVisError(path + " has an unknown element type.");
+	return header;
+}
+
+// Reads the elements of either type into a matrix of type T, after checking that the file holds
+// exactly as many elements as its header promises.
+template<class T>
+static arma::Mat< T > readElements(const std::string& path) {
+	std::ifstream in(path.c_str(), std::ios::binary);
+	const Header header = readHeader(in, path);
+	const uint64_t size = (header.type == DOUBLES) ? sizeof(double) : sizeof(int32_t);
+	const uint64_t limit = std::min< uint64_t >(std::numeric_limits< arma::uword >::max(),
+	                                            std::numeric_limits< std::streamsize >::max()) / size;
+	if (header.cols != 0 && header.rows > limit / header.cols) throw LargeVisError(path + " declares too many elements.");
+	const uint64_t n = header.rows * header.cols;
+
+	const std::streampos start = in.tellg();
+	in.seekg(0, std::ios::end);
+	const std::streampos end = in.tellg();
+	in.seekg(start);
+	if (! in || start < 0 || end < start) throw LargeVisError("Cannot read " + path);
+	const uint64_t remaining = end - start;
+	if (remaining < n * size) throw LargeVisError(path + " ends before its last element.");
+	if (remaining > n * size) throw LargeVisError(path + " has data after its last element.");
+
+	arma::Mat< T > matrix(header.rows, header.cols);
+	if (header.type == DOUBLES) {
+		std::vector< double > values(n);
+		if (! in.read((char*) values.data(), n * size)) throw LargeVisError("Cannot read the elements of " + path);
+		std::copy(values.begin(), values.end(), matrix.begin());
+	} else {
+		std::vector< int32_t > values(n);
+		if (! in.read((char*) values.data(), n * size)) throw LargeVisError("Cannot read the elements of " + path);
+		std::copy(values.begin(), values.end(), matrix.begin());
+	}
+	return matrix;
+}
+
+arma::mat readMatrix(const std::string& path) {
+	return readElements< double >(path);
+}
+
+arma::imat readIntegerMatrix(const std::string& path) {
+	return readElements< arma::sword >(path);
+}
+
+static void writeElements(const std::string& path, const uint32_t& type,
+                          const arma::uword& rows, const arma::uword& cols,
+                          const char* elements, const size_t& bytes) {
+	std::ofstream out(path.c_str(), std::ios::binary | std::ios::trunc);
+	Header header;
+	memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.type = type;
+	header.rows = rows;
+	header.cols = cols;
+	out.write((const char*) &header, sizeof(header));
+	out.write(elements, bytes);
+	if (! out) throw LargeVisError("Cannot write " + path);
+}
+
+void writeMatrix(const std::string& path, const arma::mat& matrix) {
+	writeElements(path, DOUBLES, matrix.n_rows, matrix.n_cols, (const char*) matrix.memptr(), matrix.n_elem * sizeof(double));
+}
+
+void writeMatrix(const std::string& path, const arma::imat& matrix) {
+	std::vector< int32_t > values(matrix.n_elem);
+	for (arma::uword i = 0; i != matrix.n_elem; ++i) values[i] = (matrix[i] < 0) ? -1 : (int32_t) matrix[i];
+	writeElements(path, INTEGERS, matrix.n_rows, matrix.n_cols, (const char*) values.data(), values.size() * sizeof(int32_t));
+}
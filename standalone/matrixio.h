@@ -0,0 +1,18 @@
+#ifndef _LARGEVISMATRIXIO
+#define _LARGEVISMATRIXIO
+#include "largeVis.h"
+#include <string>
+
+/*
+ * Dense matrices in the binary files read and written by the command-line driver: the four bytes
+ * "LVMX", a 32-bit element type (1 for 64-bit doubles, 2 for 32-bit integers), the number of rows
+ * and of columns as 64-bit integers, and then the elements in column-major order, all in the byte
+ * order of the machine. Each column is a point, as in the matrices the R functions take.
+ *
+ * Either element type may be read as a matrix of either kind. Missing integers are written as -1.
+ */
+arma::mat readMatrix(const std::string& path);
+arma::imat readIntegerMatrix(const std::string& path);
+void writeMatrix(const std::string& path, const arma::mat& matrix);
+void writeMatrix(const std::string& path, const arma::imat& matrix);
+#endif
@@ -0,0 +1,89 @@
+#ifndef _LARGEVISSTANDALONEPROGRESS
+#define _LARGEVISSTANDALONEPROGRESS
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/*
+ * The part of RcppProgress's Progress that the engines use, for the standalone build: a percentage
+ * on standard error in place of the progress bar, and SIGINT in place of R's user interrupt.
+ *
+ * As with RcppProgress, only the master thread updates the display and looks for the interrupt;
+ * other threads count, and read whether the run has been aborted. An interrupt aborts every
+ * Progress for the rest of the process, so that a pipeline of engines stops as a whole, and a
+ * second interrupt exits at once.
+ */
+class Progress {
+private:
+	const unsigned long max;
+	const bool display;
+	std::atomic< unsigned long > current;
+	int shown = -1; // The percentage last displayed
+
+	static std::atomic< bool >& interrupted() {
+		static std::atomic< bool > flag(false);
+		return flag;
+	}
+
+	static void interrupt(int) {
+		if (interrupted().exchange(true)) std::_Exit(130);
+	}
+
+	static bool master() {
+#ifdef _OPENMP
+		return omp_get_thread_num() == 0;
+#else
+		return true;
+#endif
+	}
+
+	void show() {
+		if (! display || ! master()) return;
+		const unsigned long done = current.load(std::memory_order_relaxed);
+		const int percent = (max == 0 || done >= max) ? 100 : (int) (100.0 * done / max);
+		if (percent == shown) return;
+		shown = percent;
+		std::fprintf(stderr, "\r%3d%%", percent);
+		std::fflush(stderr);
+	}
+
+public:
+	Progress(const unsigned long& max, const bool& display_progress = true) :
+		max{max}, display{display_progress}, current(0) {
+		static const bool installed = (std::signal(SIGINT, interrupt), true);
+		(void) installed;
+	}
+
+	~Progress() {
+		if (display && shown >= 0) std::fprintf(stderr, "\n");
+	}
+
+	// For members initialized from a temporary, which has not displayed anything yet.
+	Progress(const Progress& other) : Progress(other.max, other.display) {}
+
+	void update(const unsigned long& value) {
+		current.store(value, std::memory_order_relaxed);
+		show();
+	}
+
+	// Counts amount more items done. Returns false once the run has been aborted.
+	bool increment(const unsigned long& amount = 1) {
+		if (is_aborted()) return false;
+		current.fetch_add(amount, std::memory_order_relaxed);
+		show();
+		return ! is_aborted();
+	}
+
+	bool is_aborted() const {
+		return check_abort();
+	}
+
+	static bool check_abort() {
+		return interrupted().load(std::memory_order_relaxed);
+	}
+};
+#endif
@@ -0,0 +1,139 @@
+#include "matrixio.h"
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace arma;
+
+/*
+ * Runs each command of the largevis driver on three well-separated blobs, and checks that the
+ * outputs have the documented shapes and find the blobs. Takes the path to the driver and a
+ * directory for the files, as CMakeLists.txt passes them to CTest.
+ */
+
+static const uword BLOBS = 3, PER_BLOB = 100, N = BLOBS * PER_BLOB;
+
+static string driver, directory;
+static int failures = 0;
+
+static void check(const bool& ok, const string& what) {
+	if (! ok) {
+		cerr << "FAILED: " << what << endl;
+		++failures;
+	}
+}
+
+static string file(const string& name) {
+	return directory + "/" + name + ".lvmx";
+}
+
+static bool run(const string& arguments) {
+	const string command = "\"" + driver + "\" " + arguments;
+	cerr << command << endl;
+	return system(command.c_str()) == 0;
+}
+
+// Copies a file with its first bytes changed, or with its last bytes cut off.
+static void damage(const string& from, const string& to, const string& head, const size_t& cut) {
+	ifstream in(from.c_str(), ios::binary);
+	string bytes((istreambuf_iterator< char >(in)), istreambuf_iterator< char >());
+	bytes.replace(0, head.size(), head);
+	bytes.resize(bytes.size() - cut);
+	ofstream(to.c_str(), ios::binary | ios::trunc) << bytes;
+}
+
+// Whether the labels, with 0 for noise, put most of each blob in one cluster of its own.
+static bool findsBlobs(const vector< long >& labels) {
+	set< long > seen;
+	for (uword b = 0; b != BLOBS; ++b) {
+		vector< uword > counts(N + 1, 0);
+		for (uword n = b * PER_BLOB; n != (b + 1) * PER_BLOB; ++n) if (labels[n] > 0) ++counts[labels[n]];
+		uword best = 1;
+		for (uword l = 1; l <= N; ++l) if (counts[l] > counts[best]) best = l;
+		if (counts[best] < PER_BLOB * 9 / 10 || ! seen.insert(best).second) return false;
+	}
+	return true;
+}
+
+int main(int argc, char** argv) {
+	if (argc != 3) {
+		cerr << "usage: smoketest <largevis> <directory>" << endl;
+		return 2;
+	}
+	driver = argv[1];
+	directory = argv[2];
+
+	mt19937_64 mt(1974);
+	normal_distribution< double > rnorm(0, 0.5);
+	mat points(2, N);
+	for (uword n = 0; n != N; ++n) {
+		points(0, n) = 10.0 * (n / PER_BLOB == 1) + rnorm(mt);
+		points(1, n) = 10.0 * (n / PER_BLOB == 2) + rnorm(mt);
+	}
+	writeMatrix(file("points"), points);
+
+	check(run("neighbors --data " + file("points") + " --out " + file("neighbors") + " --K 10 --seed 1 --threads 2"),
+	      "neighbors runs");
+	const imat knns = readIntegerMatrix(file("neighbors"));
+	check(knns.n_rows == 10 && knns.n_cols == N, "neighbors has K rows and a column for each point");
+	bool sameBlob = true;
+	for (uword n = 0; n != knns.n_cols; ++n) for (uword k = 0; k != knns.n_rows; ++k) {
+		sameBlob = sameBlob && knns(k, n) >= 0 && (uword) knns(k, n) / PER_BLOB == n / PER_BLOB;
+	}
+	check(sameBlob, "the neighbors of each point are in its blob");
+
+	check(run("dbscan --data " + file("points") + " --out " + file("dbscan") + " --eps 1 --minPts 5 --profile"),
+	      "dbscan runs");
+	const imat db = readIntegerMatrix(file("dbscan"));
+	check(db.n_rows == 1 && db.n_cols == N, "dbscan has one row");
+	check(findsBlobs(vector< long >(db.begin(), db.end())), "dbscan finds the blobs");
+
+	check(run("optics --data " + file("points") + " --out " + file("optics") + " --eps 2 --minPts 5"), "optics runs");
+	const mat op = readMatrix(file("optics"));
+	check(op.n_rows == 4 && op.n_cols == N, "optics has four rows");
+	set< double > order;
+	for (uword n = 0; n != op.n_cols; ++n) order.insert(op(0, n));
+	check(order.size() == N && *order.begin() == 0 && *order.rbegin() == N - 1, "the optics ordering visits each point once");
+
+	check(run("hdbscan --data " + file("points") + " --neighbors " + file("neighbors") + " --out " + file("hdbscan") +
+	          " --K 5 --minPts 20"), "hdbscan runs");
+	const mat hd = readMatrix(file("hdbscan"));
+	check(hd.n_rows == 4 && hd.n_cols == N, "hdbscan has four rows");
+	vector< long > clusters(hd.n_cols);
+	for (uword n = 0; n != hd.n_cols; ++n) clusters[n] = hd(0, n);
+	check(findsBlobs(clusters), "hdbscan finds the blobs");
+
+	check(run("embed --data " + file("points") + " --neighbors " + file("neighbors") + " --out " + file("coords") +
+	          " --samples 100000 --seed 1"), "embed runs");
+	const mat coords = readMatrix(file("coords"));
+	bool finite = true;
+	for (auto it = coords.begin(); it != coords.end(); ++it) finite = finite && std::isfinite(*it);
+	check(coords.n_rows == 2 && coords.n_cols == N && finite, "embed has finite coordinates in two rows");
+
+	check(! run("dbscan --data " + file("missing") + " --out " + file("dbscan") + " --eps 1 --minPts 5"),
+	      "a missing input fails");
+	damage(file("points"), file("truncated"), string(), sizeof(double));
+	check(! run("dbscan --data " + file("truncated") + " --out " + file("dbscan") + " --eps 1 --minPts 5"),
+	      "a truncated input fails");
+	// A header that declares 2^62 rows and 2^62 columns.
+	const uint32_t type = 1;
+	const uint64_t huge = uint64_t(1) << 62;
+	string header("LVMX");
+	header.append((const char*) &type, sizeof(type));
+	header.append((const char*) &huge, sizeof(huge));
+	header.append((const char*) &huge, sizeof(huge));
+	damage(file("points"), file("huge"), header, 0);
+	check(! run("dbscan --data " + file("huge") + " --out " + file("dbscan") + " --eps 1 --minPts 5"),
+	      "an input that declares too many elements fails");
+
+	if (failures == 0) cerr << "All checks passed." << endl;
+	return failures == 0 ? 0 : 1;
+}